@@ -0,0 +1,384 @@
+#include "stdafx.h"
+#include "AnagramIndex.h"
+#include "ParseCache.h"
+#include "Utilities.h"
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+
+namespace AdventOfCode2017
+{
+    namespace
+    {
+        const uint32_t Magic = 0x58444941;
+        const uint32_t Version = 1;
+        const size_t MinimumChunkBytes = 64 * 1024;
+        const std::string_view Delimiters = " \r\n";
+
+        // Header layout, one 32-bit word each.
+        enum headerField
+        {
+            MagicField,
+            VersionField,
+            LinesField,
+            ClassesField,
+            SlotsField,
+            PostingsField,
+            KeyBytesField,
+            HeaderWords = 8
+        };
+
+        // Each slot is a fingerprint (the high half of the hash) and a class
+        // number plus one, zero when empty. Each class is the offset and
+        // length of its sorted bytes, then the offset and length of its
+        // posting list.
+        const size_t SlotWords = 2;
+        const size_t ClassWords = 4;
+
+        uint64_t KeyHash(std::string_view sorted)
+        {
+            return Mix(HashContents(sorted));
+        }
+
+        struct pendingWord
+        {
+            uint64_t hash;
+            uint32_t line;
+            uint32_t keyOffset;
+            uint32_t keyLength;
+        };
+
+        // The words of one chunk of lines, with their sorted bytes end to end
+        // in keys and the words themselves split by hash partition.
+        struct chunkWords
+        {
+            std::string keys;
+            std::vector<std::vector<pendingWord>> partitions;
+            uint32_t lines;
+        };
+
+        // The classes of one hash partition, with offsets local to it.
+        struct partitionClasses
+        {
+            std::vector<uint64_t> hashes;
+            std::vector<uint32_t> classes;
+            std::vector<uint32_t> postings;
+            std::string keys;
+        };
+
+        size_t KeyWords(size_t keyBytes)
+        {
+            return (keyBytes + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+        }
+    }
+
+    AnagramIndex::AnagramIndex(std::string_view contents, ThreadPool& pool)
+    {
+        auto chunkCount = std::min(pool.Size() * 4, std::max(contents.size() / MinimumChunkBytes, size_t(1)));
+        auto chunks = SplitChunks(contents, chunkCount);
+        auto partitionCount = pool.Size() * 4;
+
+        std::vector<chunkWords> words(chunks.size());
+        pool.Run(
+            chunks.size(),
+            [&chunks, &words, partitionCount](size_t index)
+            {
+                auto& chunk = words[index];
+                chunk.partitions.resize(partitionCount);
+                chunk.lines = 0;
+
+                ForEachLine(
+                    chunks[index],
+                    [&chunk, partitionCount](std::string_view line)
+                    {
+                        for (auto word = NextToken(line, Delimiters); !word.empty(); word = NextToken(line, Delimiters))
+                        {
+                            auto offset = chunk.keys.size();
+                            chunk.keys.append(word.data(), word.size());
+                            std::sort(chunk.keys.begin() + offset, chunk.keys.end());
+
+                            auto hash = KeyHash(std::string_view(chunk.keys).substr(offset));
+                            auto& partition = chunk.partitions[(hash >> 32) % partitionCount];
+                            partition.push_back(pendingWord{ hash, chunk.lines, static_cast<uint32_t>(offset), static_cast<uint32_t>(word.size()) });
+                        }
+
+                        chunk.lines++;
+                    });
+            });
+
+        std::vector<uint32_t> lineBase(words.size() + 1, 0);
+        for (auto ii = size_t(0); ii < words.size(); ii++)
+        {
+            lineBase[ii + 1] = lineBase[ii] + words[ii].lines;
+        }
+
+        std::vector<partitionClasses> parts(partitionCount);
+        pool.Run(
+            partitionCount,
+            [&words, &lineBase, &parts](size_t index)
+            {
+                struct entry
+                {
+                    uint64_t hash;
+                    uint32_t line;
+                    std::string_view key;
+                };
+
+                std::vector<entry> entries;
+                for (auto chunk = size_t(0); chunk < words.size(); chunk++)
+                {
+                    auto keys = std::string_view(words[chunk].keys);
+                    for (auto& word : words[chunk].partitions[index])
+                    {
+                        entries.push_back(entry{ word.hash, lineBase[chunk] + word.line, keys.substr(word.keyOffset, word.keyLength) });
+                    }
+                }
+
+                std::sort(
+                    entries.begin(),
+                    entries.end(),
+                    [](const entry& left, const entry& right)
+                    {
+                        if (left.hash != right.hash)
+                        {
+                            return left.hash < right.hash;
+                        }
+
+                        auto order = left.key.compare(right.key);
+                        return order != 0 ? order < 0 : left.line < right.line;
+                    });
+
+                auto& part = parts[index];
+                for (auto first = size_t(0); first < entries.size(); )
+                {
+                    auto& key = entries[first].key;
+                    auto postingStart = part.postings.size();
+
+                    part.hashes.push_back(entries[first].hash);
+                    part.classes.push_back(static_cast<uint32_t>(part.keys.size()));
+                    part.classes.push_back(static_cast<uint32_t>(key.size()));
+                    part.classes.push_back(static_cast<uint32_t>(postingStart));
+                    part.keys.append(key.data(), key.size());
+
+                    auto last = first;
+                    for (; last < entries.size() && entries[last].hash == entries[first].hash && entries[last].key == key; last++)
+                    {
+                        if (part.postings.size() == postingStart || part.postings.back() != entries[last].line)
+                        {
+                            part.postings.push_back(entries[last].line);
+                        }
+                    }
+
+                    part.classes.push_back(static_cast<uint32_t>(part.postings.size() - postingStart));
+                    first = last;
+                }
+            });
+
+        std::vector<size_t> classBase(partitionCount + 1, 0);
+        std::vector<size_t> postingBase(partitionCount + 1, 0);
+        std::vector<size_t> keyBase(partitionCount + 1, 0);
+        for (auto ii = size_t(0); ii < partitionCount; ii++)
+        {
+            classBase[ii + 1] = classBase[ii] + parts[ii].hashes.size();
+            postingBase[ii + 1] = postingBase[ii] + parts[ii].postings.size();
+            keyBase[ii + 1] = keyBase[ii] + parts[ii].keys.size();
+        }
+
+        auto classCount = classBase[partitionCount];
+        auto postingCount = postingBase[partitionCount];
+        auto keyBytes = keyBase[partitionCount];
+
+        // At most half full, so probes stay short and always end.
+        auto slotCount = size_t(16);
+        while (slotCount < 2 * classCount)
+        {
+            slotCount *= 2;
+        }
+
+        auto slotStart = size_t(HeaderWords);
+        auto classStart = slotStart + SlotWords * slotCount;
+        auto postingStart = classStart + ClassWords * classCount;
+        auto keyStart = postingStart + postingCount;
+
+        storage.assign(keyStart + KeyWords(keyBytes), 0);
+        storage[MagicField] = Magic;
+        storage[VersionField] = Version;
+        storage[LinesField] = lineBase.back();
+        storage[ClassesField] = static_cast<uint32_t>(classCount);
+        storage[SlotsField] = static_cast<uint32_t>(slotCount);
+        storage[PostingsField] = static_cast<uint32_t>(postingCount);
+        storage[KeyBytesField] = static_cast<uint32_t>(keyBytes);
+
+        auto data = storage.data();
+        pool.Run(
+            partitionCount,
+            [&](size_t index)
+            {
+                auto& part = parts[index];
+                auto target = data + classStart + ClassWords * classBase[index];
+                for (auto ii = size_t(0); ii < part.classes.size(); ii += ClassWords)
+                {
+                    target[ii] = static_cast<uint32_t>(part.classes[ii] + keyBase[index]);
+                    target[ii + 1] = part.classes[ii + 1];
+                    target[ii + 2] = static_cast<uint32_t>(part.classes[ii + 2] + postingBase[index]);
+                    target[ii + 3] = part.classes[ii + 3];
+                }
+
+                std::copy(part.postings.begin(), part.postings.end(), data + postingStart + postingBase[index]);
+                memcpy(reinterpret_cast<char*>(data + keyStart) + keyBase[index], part.keys.data(), part.keys.size());
+            });
+
+        auto mask = slotCount - 1;
+        for (auto index = size_t(0); index < partitionCount; index++)
+        {
+            auto& hashes = parts[index].hashes;
+            for (auto ii = size_t(0); ii < hashes.size(); ii++)
+            {
+                auto slot = hashes[ii] & mask;
+                while (data[slotStart + SlotWords * slot + 1] != 0)
+                {
+                    slot = (slot + 1) & mask;
+                }
+
+                data[slotStart + SlotWords * slot] = static_cast<uint32_t>(hashes[ii] >> 32);
+                data[slotStart + SlotWords * slot + 1] = static_cast<uint32_t>(classBase[index] + ii + 1);
+            }
+        }
+
+        Attach(storage.data(), storage.size());
+    }
+
+    AnagramIndex AnagramIndex::Open(const std::string& fileName)
+    {
+        AnagramIndex index;
+        index.mapping.emplace(fileName);
+
+        auto contents = index.mapping->Contents();
+        if (contents.size() % sizeof(uint32_t) != 0)
+        {
+            throw 1;
+        }
+
+        index.Attach(reinterpret_cast<const uint32_t*>(contents.data()), contents.size() / sizeof(uint32_t));
+        return index;
+    }
+
+    void AnagramIndex::Attach(const uint32_t* data, size_t words)
+    {
+        if (words < HeaderWords || data[MagicField] != Magic || data[VersionField] != Version)
+        {
+            throw 1;
+        }
+
+        auto slotCount = uint64_t(data[SlotsField]);
+        auto classCount = uint64_t(data[ClassesField]);
+        auto postingCount = uint64_t(data[PostingsField]);
+        auto keyBytes = uint64_t(data[KeyBytesField]);
+
+        auto expected = HeaderWords + SlotWords * slotCount + ClassWords * classCount + postingCount + KeyWords(keyBytes);
+        if (slotCount == 0 || (slotCount & (slotCount - 1)) != 0 || slotCount < 2 * classCount || expected != words)
+        {
+            throw 1;
+        }
+
+        header = data;
+        slots = header + HeaderWords;
+        classes = slots + SlotWords * slotCount;
+        postings = classes + ClassWords * classCount;
+        keys = reinterpret_cast<const char*>(postings + postingCount);
+        size = words;
+
+        // Lookups trust these, so a damaged file is rejected here.
+        for (auto ii = size_t(0); ii < classCount; ii++)
+        {
+            auto entry = classes + ClassWords * ii;
+            if (uint64_t(entry[0]) + entry[1] > keyBytes || uint64_t(entry[2]) + entry[3] > postingCount)
+            {
+                throw 1;
+            }
+        }
+
+        // Every class fills exactly one slot; with more, a probe for a
+        // missing key might never reach an empty slot.
+        auto filled = uint64_t(0);
+        for (auto ii = size_t(0); ii < slotCount; ii++)
+        {
+            if (slots[SlotWords * ii + 1] > classCount)
+            {
+                throw 1;
+            }
+
+            filled += slots[SlotWords * ii + 1] != 0;
+        }
+
+        if (filled != classCount)
+        {
+            throw 1;
+        }
+    }
+
+    void AnagramIndex::Save(const std::string& fileName) const
+    {
+        std::ofstream output(fileName, std::ios::binary | std::ios::trunc);
+        output.write(reinterpret_cast<const char*>(header), size * sizeof(uint32_t));
+
+        if (!output)
+        {
+            throw 1;
+        }
+    }
+
+    LineIdList AnagramIndex::LinesWithAnagram(std::string_view word) const
+    {
+        char buffer[64];
+        std::string longWord;
+        std::string_view key;
+
+        if (word.size() <= sizeof(buffer))
+        {
+            memcpy(buffer, word.data(), word.size());
+            std::sort(buffer, buffer + word.size());
+            key = std::string_view(buffer, word.size());
+        }
+        else
+        {
+            longWord.assign(word.data(), word.size());
+            std::sort(longWord.begin(), longWord.end());
+            key = longWord;
+        }
+
+        auto hash = KeyHash(key);
+        auto fingerprint = static_cast<uint32_t>(hash >> 32);
+        auto mask = header[SlotsField] - size_t(1);
+
+        for (auto slot = hash & mask; ; slot = (slot + 1) & mask)
+        {
+            auto classNumber = slots[SlotWords * slot + 1];
+            if (classNumber == 0)
+            {
+                return LineIdList{ nullptr, nullptr };
+            }
+
+            auto entry = classes + ClassWords * (classNumber - 1);
+            if (slots[SlotWords * slot] == fingerprint && entry[1] == key.size() && memcmp(keys + entry[0], key.data(), key.size()) == 0)
+            {
+                return LineIdList{ postings + entry[2], postings + entry[2] + entry[3] };
+            }
+        }
+    }
+
+    size_t AnagramIndex::LineCount() const
+    {
+        return header[LinesField];
+    }
+
+    size_t AnagramIndex::ClassCount() const
+    {
+        return header[ClassesField];
+    }
+
+    size_t AnagramIndex::PostingCount() const
+    {
+        return header[PostingsField];
+    }
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Utilities.h"
+#include "Parallel.h"
+#include <vector>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+
+namespace AdventOfCode2017
+{
+    // Ascending line numbers (0-based, in MappedInput::Lines order).
+    struct LineIdList
+    {
+        const uint32_t* first;
+        const uint32_t* last;
+
+        const uint32_t* begin() const { return first; }
+
+        const uint32_t* end() const { return last; }
+
+        size_t size() const { return static_cast<size_t>(last - first); }
+
+        bool empty() const { return first == last; }
+    };
+
+    // Every anagram class of the words in a file, mapped to the lines that
+    // contain a word of that class. Words split as IsValidPassphrase splits
+    // them, and two words are in one class when they hold the same bytes in
+    // any order.
+    //
+    // The whole index is one buffer of 32-bit words: a header, a hash table
+    // of classes, the classes, their posting lists and the classes' sorted
+    // bytes. The buffer is written to disk as is, so an opened file is used
+    // straight from its mapping.
+    class AnagramIndex
+    {
+    public:
+        // Builds the index over the pool: chunks of lines are tokenized in
+        // parallel, then each hash partition is sorted into classes.
+        explicit AnagramIndex(std::string_view contents, ThreadPool& pool = ThreadPool::Default());
+
+        // Maps an index written by Save. Throws if it is not a valid index.
+        static AnagramIndex Open(const std::string& fileName);
+
+        void Save(const std::string& fileName) const;
+
+        // Lines containing an anagram of word, including word itself.
+        LineIdList LinesWithAnagram(std::string_view word) const;
+
+        size_t LineCount() const;
+
+        size_t ClassCount() const;
+
+        size_t PostingCount() const;
+
+    private:
+        AnagramIndex() = default;
+
+        void Attach(const uint32_t* data, size_t words);
+
+        std::vector<uint32_t> storage;
+        std::optional<MappedInput> mapping;
+
+        const uint32_t* header = nullptr;
+        const uint32_t* slots = nullptr;
+        const uint32_t* classes = nullptr;
+        const uint32_t* postings = nullptr;
+        const char* keys = nullptr;
+        size_t size = 0;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,521 @@
+#include "stdafx.h"
+#include "Captcha.h"
+#include <vector>
+#include <algorithm>
+#include <cctype>
+#include <intrin.h>
+
+namespace AdventOfCode2017
+{
+    namespace
+    {
+        const size_t MinimumChunkSize = 256 * 1024;
+
+        // Sum of the digits of first that equal the byte at the same offset
+        // in second.
+        uint64_t SumMatchesScalar(const char* first, const char* second, size_t count)
+        {
+            auto total = uint64_t(0);
+
+            for (auto ii = size_t(0); ii < count; ii++)
+            {
+                if (first[ii] == second[ii])
+                {
+                    total += first[ii] - '0';
+                }
+            }
+
+            return total;
+        }
+
+        uint64_t SumLanes(__m128i sums)
+        {
+            uint64_t lanes[2];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sums);
+            return lanes[0] + lanes[1];
+        }
+
+        uint64_t SumMatchesSse(const char* first, const char* second, size_t count)
+        {
+            const auto zero = _mm_setzero_si128();
+            const auto ascii = _mm_set1_epi8('0');
+            auto sums = _mm_setzero_si128();
+
+            auto ii = size_t(0);
+            for (; ii + 16 <= count; ii += 16)
+            {
+                auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + ii));
+                auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(second + ii));
+
+                // Matching digit values, zero elsewhere, summed into two 64-bit lanes.
+                auto matched = _mm_and_si128(_mm_cmpeq_epi8(a, b), _mm_sub_epi8(a, ascii));
+                sums = _mm_add_epi64(sums, _mm_sad_epu8(matched, zero));
+            }
+
+            return SumLanes(sums) + SumMatchesScalar(first + ii, second + ii, count - ii);
+        }
+
+        uint64_t SumMatchesAvx2(const char* first, const char* second, size_t count)
+        {
+            const auto zero = _mm256_setzero_si256();
+            const auto ascii = _mm256_set1_epi8('0');
+            auto sums = _mm256_setzero_si256();
+
+            auto ii = size_t(0);
+            for (; ii + 32 <= count; ii += 32)
+            {
+                auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + ii));
+                auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(second + ii));
+
+                auto matched = _mm256_and_si256(_mm256_cmpeq_epi8(a, b), _mm256_sub_epi8(a, ascii));
+                sums = _mm256_add_epi64(sums, _mm256_sad_epu8(matched, zero));
+            }
+
+            auto folded = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+            return SumLanes(folded) + SumMatchesScalar(first + ii, second + ii, count - ii);
+        }
+
+        uint64_t SumMatches(const char* first, const char* second, size_t count, SimdLevel level)
+        {
+            switch (level)
+            {
+            case SimdLevel::Avx2:
+                return SumMatchesAvx2(first, second, count);
+            case SimdLevel::Sse41:
+                return SumMatchesSse(first, second, count);
+            default:
+                return SumMatchesScalar(first, second, count);
+            }
+        }
+
+        // Captcha contributions of the positions [begin, end). The partner of
+        // position i is i + step up to length - step and i + step - length
+        // after that, so the ring is two straight comparisons.
+        uint64_t CaptchaRange(std::string_view digits, size_t step, size_t begin, size_t end, SimdLevel level)
+        {
+            auto data = digits.data();
+            auto length = digits.size();
+            auto split = length - step;
+
+            auto total = uint64_t(0);
+
+            if (begin < split)
+            {
+                auto last = std::min(end, split);
+                total += SumMatches(data + begin, data + begin + step, last - begin, level);
+            }
+
+            if (end > split)
+            {
+                auto first = std::max(begin, split);
+                total += SumMatches(data + first, data + first - split, end - first, level);
+            }
+
+            return total;
+        }
+
+        const size_t BitParallelLimit = 1024;
+
+        uint64_t PopCount(uint64_t value)
+        {
+            value = value - ((value >> 1) & 0x5555555555555555ull);
+            value = (value & 0x3333333333333333ull) + ((value >> 2) & 0x3333333333333333ull);
+            value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+            return (value * 0x0101010101010101ull) >> 56;
+        }
+
+        std::vector<uint64_t> BitParallelSpectrum(std::string_view digits)
+        {
+            auto length = digits.size();
+            auto words = (length + 63) / 64;
+            auto lastMask = length % 64 == 0 ? ~uint64_t(0) : (uint64_t(1) << (length % 64)) - 1;
+
+            std::vector<uint64_t> spectrum(length, 0);
+
+            // Each digit's positions written out twice, so every rotation of
+            // the ring is a plain shifted read.
+            std::vector<uint64_t> doubled(2 * words + 1);
+
+            for (auto digit = 1; digit <= 9; digit++)
+            {
+                std::fill(doubled.begin(), doubled.end(), 0);
+
+                auto present = false;
+                for (auto ii = size_t(0); ii < length; ii++)
+                {
+                    if (digits[ii] == '0' + digit)
+                    {
+                        doubled[ii / 64] |= uint64_t(1) << (ii % 64);
+                        doubled[(ii + length) / 64] |= uint64_t(1) << ((ii + length) % 64);
+                        present = true;
+                    }
+                }
+
+                if (!present)
+                {
+                    continue;
+                }
+
+                for (auto step = size_t(0); step < length; step++)
+                {
+                    auto offset = step / 64;
+                    auto shift = step % 64;
+                    auto matches = uint64_t(0);
+
+                    for (auto word = size_t(0); word < words; word++)
+                    {
+                        auto bits = word == words - 1 ? doubled[word] & lastMask : doubled[word];
+                        auto rotated = doubled[offset + word] >> shift;
+
+                        if (shift != 0)
+                        {
+                            rotated |= doubled[offset + word + 1] << (64 - shift);
+                        }
+
+                        matches += PopCount(bits & rotated);
+                    }
+
+                    spectrum[step] += digit * matches;
+                }
+            }
+
+            return spectrum;
+        }
+
+        const uint32_t TransformModulus = 998244353; // 119 * 2^23 + 1
+        const uint32_t TransformRoot = 3;
+
+        uint32_t MultiplyMod(uint32_t a, uint32_t b)
+        {
+            return static_cast<uint32_t>(uint64_t(a) * b % TransformModulus);
+        }
+
+        uint32_t PowerMod(uint32_t base, uint64_t exponent)
+        {
+            auto result = uint32_t(1);
+
+            for (; exponent > 0; exponent >>= 1)
+            {
+                if (exponent & 1)
+                {
+                    result = MultiplyMod(result, base);
+                }
+
+                base = MultiplyMod(base, base);
+            }
+
+            return result;
+        }
+
+        // In-place iterative number theoretic transform; the size must be a
+        // power of two no larger than 2^23.
+        void Transform(std::vector<uint32_t>& values, bool inverse)
+        {
+            auto size = values.size();
+
+            for (auto ii = size_t(1), jj = size_t(0); ii < size; ii++)
+            {
+                auto bit = size >> 1;
+                for (; (jj & bit) != 0; bit >>= 1)
+                {
+                    jj ^= bit;
+                }
+
+                jj ^= bit;
+
+                if (ii < jj)
+                {
+                    std::swap(values[ii], values[jj]);
+                }
+            }
+
+            std::vector<uint32_t> twiddles;
+
+            for (auto length = size_t(2); length <= size; length <<= 1)
+            {
+                auto root = PowerMod(TransformRoot, (TransformModulus - 1) / length);
+                if (inverse)
+                {
+                    root = PowerMod(root, TransformModulus - 2);
+                }
+
+                auto half = length / 2;
+                twiddles.resize(half);
+                twiddles[0] = 1;
+                for (auto kk = size_t(1); kk < half; kk++)
+                {
+                    twiddles[kk] = MultiplyMod(twiddles[kk - 1], root);
+                }
+
+                for (auto start = size_t(0); start < size; start += length)
+                {
+                    for (auto kk = size_t(0); kk < half; kk++)
+                    {
+                        auto even = values[start + kk];
+                        auto odd = MultiplyMod(values[start + kk + half], twiddles[kk]);
+
+                        auto sum = even + odd;
+                        values[start + kk] = sum >= TransformModulus ? sum - TransformModulus : sum;
+                        values[start + kk + half] = even >= odd ? even - odd : even + TransformModulus - odd;
+                    }
+                }
+            }
+
+            if (inverse)
+            {
+                auto scale = PowerMod(static_cast<uint32_t>(size), TransformModulus - 2);
+                for (auto& value : values)
+                {
+                    value = MultiplyMod(value, scale);
+                }
+            }
+        }
+
+        std::vector<uint64_t> TransformSpectrum(std::string_view digits)
+        {
+            auto length = digits.size();
+            if (length > MaximumTransformDigits)
+            {
+                throw 1;
+            }
+
+            // Zero padding to at least twice the length keeps the positive
+            // and negative lags of the correlation apart.
+            auto size = size_t(1);
+            while (size < 2 * length)
+            {
+                size <<= 1;
+            }
+
+            std::vector<uint32_t> indicator(size);
+            std::vector<uint32_t> weighted(size, 0);
+
+            for (auto digit = uint32_t(1); digit <= 9; digit++)
+            {
+                std::fill(indicator.begin(), indicator.end(), 0);
+
+                auto present = false;
+                for (auto ii = size_t(0); ii < length; ii++)
+                {
+                    if (digits[ii] == static_cast<char>('0' + digit))
+                    {
+                        indicator[ii] = 1;
+                        present = true;
+                    }
+                }
+
+                if (!present)
+                {
+                    continue;
+                }
+
+                Transform(indicator, false);
+
+                // The transform of the reversed sequence is this one read
+                // backwards, so one forward transform per digit is enough.
+                for (auto kk = size_t(0); kk < size; kk++)
+                {
+                    auto power = MultiplyMod(indicator[kk], indicator[(size - kk) & (size - 1)]);
+                    weighted[kk] = (weighted[kk] + MultiplyMod(digit, power)) % TransformModulus;
+                }
+            }
+
+            Transform(weighted, true);
+
+            // A step around the ring is the sum of lag step and lag step - length.
+            std::vector<uint64_t> spectrum(length);
+            for (auto step = size_t(0); step < length; step++)
+            {
+                spectrum[step] = uint64_t(weighted[step]) + weighted[size - length + step];
+            }
+
+            return spectrum;
+        }
+    }
+
+    uint64_t CaptchaSum(std::string_view digits, size_t step, SimdLevel level)
+    {
+        if (digits.empty())
+        {
+            return 0;
+        }
+
+        return CaptchaRange(digits, step % digits.size(), 0, digits.size(), level);
+    }
+
+    uint64_t ParallelCaptchaSum(std::string_view digits, size_t step, ThreadPool& pool, SimdLevel level)
+    {
+        auto length = digits.size();
+        auto chunkCount = std::min(pool.Size() * 4, length / MinimumChunkSize);
+
+        if (chunkCount <= 1)
+        {
+            return CaptchaSum(digits, step, level);
+        }
+
+        step %= length;
+        std::vector<uint64_t> partials(chunkCount);
+
+        pool.Run(
+            chunkCount,
+            [&](size_t chunk)
+            {
+                auto begin = length * chunk / chunkCount;
+                auto end = length * (chunk + 1) / chunkCount;
+                partials[chunk] = CaptchaRange(digits, step, begin, end, level);
+            });
+
+        auto total = uint64_t(0);
+        for (auto partial : partials)
+        {
+            total += partial;
+        }
+
+        return total;
+    }
+
+    std::vector<uint64_t> CaptchaSpectrum(std::string_view digits, SpectrumMethod method)
+    {
+        if (method == SpectrumMethod::Automatic)
+        {
+            method = digits.size() <= BitParallelLimit ? SpectrumMethod::BitParallel : SpectrumMethod::Transform;
+        }
+
+        return method == SpectrumMethod::BitParallel ? BitParallelSpectrum(digits) : TransformSpectrum(digits);
+    }
+
+    namespace
+    {
+        std::ifstream OpenAt(const std::string& fileName, uint64_t position)
+        {
+            std::ifstream input(fileName, std::ios::in | std::ios::binary);
+            input.seekg(static_cast<std::streamoff>(position));
+
+            if (input.fail())
+            {
+                throw 1;
+            }
+
+            return input;
+        }
+
+        void ReadExactly(std::ifstream& input, char* buffer, size_t count)
+        {
+            input.read(buffer, count);
+
+            if (static_cast<size_t>(input.gcount()) != count)
+            {
+                throw 1;
+            }
+        }
+    }
+
+    StreamingCaptcha::StreamingCaptcha(const std::string& fileName, size_t blockSize) :
+        fileName(fileName),
+        blockSize(std::max(blockSize, size_t(1))),
+        length(0)
+    {
+        std::ifstream input(fileName, std::ios::in | std::ios::binary | std::ios::ate);
+        if (input.fail())
+        {
+            throw 1;
+        }
+
+        length = static_cast<uint64_t>(input.tellg());
+
+        while (length > 0)
+        {
+            input.seekg(static_cast<std::streamoff>(length - 1));
+            if (!isspace(input.get()))
+            {
+                break;
+            }
+
+            length--;
+        }
+    }
+
+    uint64_t StreamingCaptcha::Sum(uint64_t step, SimdLevel level)
+    {
+        if (length == 0)
+        {
+            return 0;
+        }
+
+        step %= length;
+
+        if (step == 1 && length > 1)
+        {
+            return SumNext(level);
+        }
+
+        auto total = SumSegment(0, step, length - step, level);
+
+        // Halfway round an even ring the second half pairs up the same digits
+        // as the first, so it adds the same amount again.
+        if (step * 2 == length)
+        {
+            return total * 2;
+        }
+
+        return total + SumSegment(length - step, 0, step, level);
+    }
+
+    uint64_t StreamingCaptcha::SumNext(SimdLevel level)
+    {
+        auto input = OpenAt(fileName, 0);
+
+        // One spare byte in front carries the last digit of the previous block.
+        std::vector<char> buffer(blockSize + 1);
+        auto carried = size_t(0);
+        auto firstDigit = '\0';
+        auto total = uint64_t(0);
+
+        for (auto remaining = length; remaining > 0;)
+        {
+            auto count = static_cast<size_t>(std::min<uint64_t>(blockSize, remaining));
+            ReadExactly(input, buffer.data() + carried, count);
+
+            if (carried == 0)
+            {
+                firstDigit = buffer[0];
+            }
+
+            auto filled = carried + count;
+            total += SumMatches(buffer.data(), buffer.data() + 1, filled - 1, level);
+
+            buffer[0] = buffer[filled - 1];
+            carried = 1;
+            remaining -= count;
+        }
+
+        if (buffer[0] == firstDigit)
+        {
+            total += firstDigit - '0';
+        }
+
+        return total;
+    }
+
+    uint64_t StreamingCaptcha::SumSegment(uint64_t first, uint64_t second, uint64_t count, SimdLevel level)
+    {
+        auto firstInput = OpenAt(fileName, first);
+        auto secondInput = OpenAt(fileName, second);
+
+        std::vector<char> firstBlock(blockSize);
+        std::vector<char> secondBlock(blockSize);
+        auto total = uint64_t(0);
+
+        while (count > 0)
+        {
+            auto size = static_cast<size_t>(std::min<uint64_t>(blockSize, count));
+            ReadExactly(firstInput, firstBlock.data(), size);
+            ReadExactly(secondInput, secondBlock.data(), size);
+
+            total += SumMatches(firstBlock.data(), secondBlock.data(), size, level);
+            count -= size;
+        }
+
+        return total;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Simd.h"
+#include "Parallel.h"
+#include <string_view>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+
+namespace AdventOfCode2017
+{
+    // Day 1 captcha over a ring of ASCII digits: the sum of every digit that
+    // matches the digit step positions further around the ring. Any step is
+    // allowed; it is taken modulo the length.
+    uint64_t CaptchaSum(std::string_view digits, size_t step, SimdLevel level = DetectSimdLevel());
+
+    // CaptchaSum split into chunks that run across the pool, for inputs of
+    // many megabytes. Small inputs are summed on the calling thread.
+    uint64_t ParallelCaptchaSum(std::string_view digits, size_t step, ThreadPool& pool = ThreadPool::Default(), SimdLevel level = DetectSimdLevel());
+
+    enum class SpectrumMethod
+    {
+        Automatic = 0,
+
+        // Per-digit bitsets ANDed against their own rotation and popcounted;
+        // O(n^2 / 64), the faster choice for short inputs.
+        BitParallel = 1,
+
+        // Per-digit circular autocorrelation through a number theoretic
+        // transform; O(n log n), for up to MaximumTransformDigits digits.
+        Transform = 2,
+    };
+
+    const size_t MaximumTransformDigits = size_t(1) << 22;
+
+    // CaptchaSum for every step at once: result[step] == CaptchaSum(digits, step)
+    // for each step in [0, digits.size()).
+    std::vector<uint64_t> CaptchaSpectrum(std::string_view digits, SpectrumMethod method = SpectrumMethod::Automatic);
+
+    // Captcha over a digit file too large to load. The file is read through
+    // at most two sequential cursors in fixed-size blocks, so memory use is
+    // two blocks whatever the file size. Whitespace at the end of the file
+    // (a trailing newline) is not part of the ring.
+    class StreamingCaptcha
+    {
+    public:
+        static const size_t DefaultBlockSize = 1024 * 1024;
+
+        explicit StreamingCaptcha(const std::string& fileName, size_t blockSize = DefaultBlockSize);
+
+        uint64_t Length() const { return length; }
+
+        // Step 1 and step Length() / 2 with an even length read the file
+        // once; any other step reads it twice.
+        uint64_t Sum(uint64_t step, SimdLevel level = DetectSimdLevel());
+
+    private:
+        uint64_t SumNext(SimdLevel level);
+        uint64_t SumSegment(uint64_t first, uint64_t second, uint64_t count, SimdLevel level);
+
+        std::string fileName;
+        size_t blockSize;
+        uint64_t length;
+    };
+}
\ No newline at end of file
@@ -1,5 +1,10 @@
 #include "stdafx.h"
 #include "CppUnitTest.h"
+#include "Captcha.h"
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <cstdio>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -121,6 +126,98 @@ namespace AdventOfCode2017
             Assert::AreEqual(4, Captcha(input, input.length() / 2));
         }
 
+        TEST_METHOD(Day1_2_Test6)
+        {
+            // Every prefix length exercises a different vector tail.
+            for (auto level = 0; level <= static_cast<int>(DetectSimdLevel()); level++)
+            {
+                for (auto length = size_t(1); length <= 100; length++)
+                {
+                    auto input = FinalInput.substr(0, length);
+
+                    for (auto step = size_t(0); step <= length + 1; step++)
+                    {
+                        auto expected = static_cast<uint64_t>(Captcha(input, step % length));
+                        Assert::AreEqual(expected, CaptchaSum(input, step, static_cast<SimdLevel>(level)));
+                    }
+                }
+            }
+
+            Assert::AreEqual(uint64_t(1097), CaptchaSum(FinalInput, 1));
+            Assert::AreEqual(uint64_t(1188), CaptchaSum(FinalInput, FinalInput.length() / 2));
+        }
+
+        TEST_METHOD(Day1_2_Test7)
+        {
+            std::string input;
+            while (input.size() < 4 * 1024 * 1024)
+            {
+                input += FinalInput;
+            }
+
+            ThreadPool pool(4);
+            const size_t steps[] = { 1, input.size() / 2, 12345, input.size() - 1 };
+
+            for (auto step : steps)
+            {
+                auto expected = CaptchaSum(input, step, SimdLevel::Scalar);
+                Assert::AreEqual(expected, CaptchaSum(input, step));
+                Assert::AreEqual(expected, ParallelCaptchaSum(input, step, pool));
+            }
+        }
+
+        TEST_METHOD(Day1_2_Test8)
+        {
+            const std::string inputs[] = { "1122", "1111", "1234", "91212129", "1212", "1221", "123425", "123123", "12131415", "7", FinalInput };
+
+            for (auto& input : inputs)
+            {
+                auto bitParallel = CaptchaSpectrum(input, SpectrumMethod::BitParallel);
+                auto transform = CaptchaSpectrum(input, SpectrumMethod::Transform);
+
+                Assert::AreEqual(input.size(), bitParallel.size());
+                Assert::AreEqual(input.size(), transform.size());
+
+                for (auto step = size_t(0); step < input.size(); step++)
+                {
+                    auto expected = static_cast<uint64_t>(Captcha(input, step));
+                    Assert::AreEqual(expected, bitParallel[step]);
+                    Assert::AreEqual(expected, transform[step]);
+                }
+            }
+
+            Assert::IsTrue(CaptchaSpectrum("").empty());
+        }
+
+        TEST_METHOD(Day1_2_Test9)
+        {
+            const auto fileName = (std::filesystem::temp_directory_path() / "Day1-stream.txt").string();
+            const std::string inputs[] = { FinalInput + FinalInput + FinalInput, FinalInput + "5", "9" };
+
+            for (auto& input : inputs)
+            {
+                {
+                    std::ofstream output(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+                    output << input << "\r\n";
+                }
+
+                // Blocks far smaller than the file make every cursor cross many of them.
+                for (auto blockSize : { size_t(1), size_t(100), size_t(4096) })
+                {
+                    StreamingCaptcha captcha(fileName, blockSize);
+                    Assert::AreEqual(uint64_t(input.size()), captcha.Length());
+
+                    const uint64_t steps[] = { 0, 1, 2, input.size() / 2, input.size() - 1, 12345 };
+                    for (auto step : steps)
+                    {
+                        Assert::AreEqual(CaptchaSum(input, static_cast<size_t>(step)), captcha.Sum(step));
+                    }
+                }
+            }
+
+            std::remove(fileName.c_str());
+        }
+
         TEST_METHOD(Day1_2_Final)
         {
             Assert::AreEqual(1188, Captcha(FinalInput, FinalInput.length() / 2));
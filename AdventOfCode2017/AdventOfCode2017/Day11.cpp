@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "CppUnitTest.h"
 #include "Utilities.h"
+#include "Tokenizer.h"
 #include <vector>
 #include <algorithm>
 #include <map>
@@ -20,7 +21,7 @@ namespace AdventOfCode2017
         nw = 5,
     };
 
-    const map<string, direction> Directions =
+    const map<string, direction, less<>> Directions =
     {
         { "n"s, direction::n },
         { "ne"s, direction::ne },
@@ -30,7 +31,7 @@ namespace AdventOfCode2017
         { "nw"s, direction::nw },
     };
 
-    void parseDirection(const string& str, vector<direction>& directions)
+    void parseDirection(string_view str, vector<direction>& directions)
     {
         if (!str.empty())
         {
@@ -46,31 +47,15 @@ namespace AdventOfCode2017
         }
     }
 
-    vector<direction> parsePath(const string& path)
+    vector<direction> parsePath(string_view path)
     {
-        istringstream stream(path);
         vector<direction> result;
 
-        string buffer;
-        for (auto letter = path.begin(); letter != path.end(); letter++)
+        for (auto token : Tokenizer(path, ", \t\r\n"))
         {
-            switch (*letter)
-            {
-            case 'n':
-            case 's':
-            case 'e':
-            case 'w':
-                buffer.push_back(*letter);
-                break;
-            case ',':
-                parseDirection(buffer, result);
-                buffer.resize(0);
-                break;
-            }
+            parseDirection(token, result);
         }
 
-        parseDirection(buffer, result);
-
         return result;
     }
 
@@ -228,8 +213,8 @@ namespace AdventOfCode2017
 
         TEST_METHOD(Day11_1_2_Final)
         {
-            auto input = ReadFile("C:\\Day11.txt");
-            auto steps = parsePath(input);
+            auto input = MappedInput("C:\\Day11.txt");
+            auto steps = parsePath(input.Contents());
 
             walker w;
             for_each(steps.begin(), steps.end(), [&w](auto step) { w.walk(step); });
@@ -1,9 +1,12 @@
 #include "stdafx.h"
 #include "CppUnitTest.h"
 #include "Utilities.h"
+#include "Parallel.h"
+#include "ParseCache.h"
+#include "ParseInt.h"
+#include "ReadAhead.h"
 #include <vector>
 #include <map>
-#include <sstream>
 #include <set>
 #include <algorithm>
 
@@ -15,28 +18,19 @@ namespace AdventOfCode2017
     TEST_CLASS(Day12)
     {
     private:
-        static pair<int, vector<int>> parsePipes(const string& description)
+        static pair<int, vector<int>> parsePipes(string_view description)
         {
-            istringstream input(description);
-
-            int rootVertex;
-            int otherVertex;
             vector<int> pipes;
-            string dummy;
-
-            input >> skipws >> rootVertex >> dummy >> otherVertex;
+            auto result = ParseIntList(description, pipes);
 
-            pipes.push_back(otherVertex);
-
-            while (!input.eof())
+            if (result.error != ParseError::None || pipes.size() < 2)
             {
-                input >> skipws >> dummy >> otherVertex;
-                if (!input.fail())
-                {
-                    pipes.push_back(otherVertex);
-                }
+                throw 1;
             }
 
+            auto rootVertex = pipes.front();
+            pipes.erase(pipes.begin());
+
             return make_pair(rootVertex, pipes);
         }
 
@@ -83,6 +77,49 @@ namespace AdventOfCode2017
             return count;
         }
 
+        static void saveGraph(BinaryWriter& writer, const map<int, vector<int>>& pipes)
+        {
+            writer.Write(static_cast<uint64_t>(pipes.size()));
+
+            for (auto node = pipes.begin(); node != pipes.end(); node++)
+            {
+                writer.Write(node->first);
+                writer.WriteVector(node->second);
+            }
+        }
+
+        static map<int, vector<int>> loadGraph(BinaryReader& reader)
+        {
+            map<int, vector<int>> pipes;
+            auto count = reader.Read<uint64_t>();
+
+            for (auto ii = uint64_t(0); ii < count; ii++)
+            {
+                auto vertex = reader.Read<int>();
+                pipes.emplace_hint(pipes.end(), vertex, reader.ReadVector<int>());
+            }
+
+            return pipes;
+        }
+
+        static map<int, vector<int>> readGraph(const string& fileName)
+        {
+            auto input = MappedInput(fileName);
+            auto contents = input.Contents();
+
+            return CachedParse(
+                HashContents(contents),
+                fileName + ".cache"s,
+                1,
+                [contents]()
+                {
+                    auto pipes = ParallelParseLines(contents, parsePipes);
+                    return map<int, vector<int>>(pipes.begin(), pipes.end());
+                },
+                saveGraph,
+                loadGraph);
+        }
+
     public:
         TEST_METHOD(Day12_1_Test1)
         {
@@ -136,10 +173,13 @@ namespace AdventOfCode2017
 
         TEST_METHOD(Day12_1_Final)
         {
-            auto lines = ReadAllLines("C:\\Day12.txt"s);
+            // Parse each line as it arrives while the rest is still being read.
             map<int, vector<int>> graph;
-
-            for_each(lines.begin(), lines.end(), [&graph](auto line) { graph.insert(parsePipes(line)); });
+            AsyncLineReader lines("C:\\Day12.txt"s);
+            for (auto iter = lines.begin(); iter != lines.end(); ++iter)
+            {
+                graph.insert(parsePipes(*iter));
+            }
 
             auto group = brokeAssDjikstra(0, graph);
 
@@ -162,10 +202,7 @@ namespace AdventOfCode2017
 
         TEST_METHOD(Day12_2_Final)
         {
-            auto lines = ReadAllLines("C:\\Day12.txt"s);
-            map<int, vector<int>> graph;
-
-            for_each(lines.begin(), lines.end(), [&graph](auto line) { graph.insert(parsePipes(line)); });
+            auto graph = readGraph("C:\\Day12.txt"s);
 
             Assert::AreEqual(171, divide(graph));
         }
@@ -1,9 +1,10 @@
 #include "stdafx.h"
 #include "CppUnitTest.h"
 #include "Utilities.h"
+#include "Parallel.h"
+#include "ParseInt.h"
 #include <vector>
 #include <map>
-#include <sstream>
 #include <algorithm>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
@@ -14,17 +15,17 @@ namespace AdventOfCode2017
     TEST_CLASS(Day13)
     {
     private:
-        static pair<int, int> parseLayer(const string& description)
+        static pair<int, int> parseLayer(string_view description)
         {
-            istringstream input(description);
+            int values[2];
+            auto result = ParseIntList(description, values, 2);
 
-            int layer;
-            int depth;
-            string dummy;
-
-            input >> skipws >> layer >> dummy >> depth;
+            if (result.error != ParseError::None || result.count != 2)
+            {
+                throw 1;
+            }
 
-            return make_pair(layer, depth);
+            return make_pair(values[0], values[1]);
         }
 
         static bool isHit(int time, int depth)
@@ -128,10 +129,9 @@ namespace AdventOfCode2017
 
         TEST_METHOD(Day13_1_Final)
         {
-            auto lines = ReadAllLines("C:\\Day13.txt"s);
-            map<int, int> layers;
-
-            for_each(lines.begin(), lines.end(), [&layers](auto line) { layers.insert(parseLayer(line)); });
+            auto input = MappedInput("C:\\Day13.txt"s);
+            auto parsed = ParallelParseLines(input.Contents(), parseLayer);
+            map<int, int> layers(parsed.begin(), parsed.end());
 
             Assert::AreEqual(1504, severity(layers));
         }
@@ -149,7 +149,7 @@ namespace AdventOfCode2017
 
         TEST_METHOD(Day13_2_Final)
         {
-            auto lines = ReadAllLines("C:\\Day13.txt"s);
+            LineReader lines("C:\\Day13.txt"s);
             map<int, int> layers;
 
             for_each(lines.begin(), lines.end(), [&layers](auto line) { layers.insert(parseLayer(line)); });
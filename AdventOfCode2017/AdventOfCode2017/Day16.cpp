@@ -1,8 +1,10 @@
 #include "stdafx.h"
 #include "CppUnitTest.h"
 #include "Utilities.h"
+#include "ParseCache.h"
+#include "ParseInt.h"
+#include "Tokenizer.h"
 #include <vector>
-#include <sstream>
 #include <algorithm>
 #include <map>
 
@@ -134,42 +136,122 @@ namespace AdventOfCode2017
             }
         };
 
-        static vector<step> parseSteps(const string& input)
+        static int parsePosition(string_view& input)
         {
-            vector<step> result;
+            int position;
+            if (ConsumeInt32(input, position) != ParseError::None)
+            {
+                throw 1;
+            }
 
-            istringstream stream(input);
+            return position;
+        }
 
-            while (!stream.eof())
-            {
-                char m;
-                int posA;
-                int posB;
-                char progA;
-                char progB;
+        static vector<step> parseSteps(string_view input)
+        {
+            vector<step> result;
 
-                stream >> m;
+            for (auto token : Tokenizer(input, ", \t\r\n"))
+            {
+                auto m = token.front();
+                token.remove_prefix(1);
 
                 switch (m)
                 {
                 case 's':
-                    stream >> posA;
-                    result.emplace_back(posA);
+                    result.emplace_back(parsePosition(token));
                     break;
                 case 'x':
-                    stream >> posA >> m >> posB;
-                    result.emplace_back(posA, posB);
+                {
+                    auto posA = parsePosition(token);
+                    if (token.empty() || token.front() != '/')
+                    {
+                        throw 1;
+                    }
+
+                    token.remove_prefix(1);
+                    result.emplace_back(posA, parsePosition(token));
                     break;
+                }
                 case 'p':
-                    stream >> progA >> m >> progB;
-                    result.emplace_back(progA, progB);
+                    if (token.size() != 3 || token[1] != '/')
+                    {
+                        throw 1;
+                    }
+
+                    result.emplace_back(token[0], token[2]);
+                    token.remove_prefix(3);
+                    break;
+                default:
+                    throw 1;
+                }
+
+                if (!token.empty())
+                {
+                    throw 1;
+                }
+            }
+
+            return result;
+        }
+
+        static void saveSteps(BinaryWriter& writer, const vector<step>& steps)
+        {
+            writer.Write(static_cast<uint64_t>(steps.size()));
+
+            for (auto aStep = steps.begin(); aStep != steps.end(); aStep++)
+            {
+                writer.Write(aStep->getMove());
+                writer.Write(aStep->getOperandA());
+                writer.Write(aStep->getOperandB());
+            }
+        }
+
+        static vector<step> loadSteps(BinaryReader& reader)
+        {
+            vector<step> result;
+            auto count = reader.Read<uint64_t>();
+
+            for (auto ii = uint64_t(0); ii < count; ii++)
+            {
+                auto m = reader.Read<danceMove>();
+                auto a = reader.Read<operand>();
+                auto b = reader.Read<operand>();
+
+                switch (m)
+                {
+                case danceMove::Spin:
+                    result.emplace_back(a.position);
                     break;
+                case danceMove::Exchange:
+                    result.emplace_back(a.position, b.position);
+                    break;
+                case danceMove::Partner:
+                    result.emplace_back(a.program, b.program);
+                    break;
+                default:
+                    throw 1;
                 }
             }
 
             return result;
         }
 
+        static vector<step> readSteps(const string& fileName)
+        {
+            // One mapping serves both the hash and, on a miss, the parse.
+            auto input = MappedInput(fileName);
+            auto contents = input.Contents();
+
+            return CachedParse(
+                HashContents(contents),
+                fileName + ".cache"s,
+                1,
+                [contents]() { return parseSteps(contents); },
+                saveSteps,
+                loadSteps);
+        }
+
         template<int NumPrograms>
         static tuple<int, int, map<string, int>> findLoop(std::vector<step>& steps)
         {
@@ -286,7 +368,7 @@ namespace AdventOfCode2017
 
         TEST_METHOD(Day16_2_Final)
         {
-            auto steps = parseSteps(ReadFile("C:\\Day16.txt"s));
+            auto steps = readSteps("C:\\Day16.txt"s);
             auto loopInfo = findLoop<16>(steps);
             Assert::AreEqual("ejkflpgnamhdcboi"s, memoizeLoop(1000000000, loopInfo));
         }
@@ -1,5 +1,8 @@
 #include "stdafx.h"
 #include "CppUnitTest.h"
+#include "Parallel.h"
+#include "ParseCache.h"
+#include "ParseInt.h"
 #include <map>
 #include <vector>
 #include <algorithm>
@@ -7,6 +10,7 @@
 #include <sstream>
 #include <iostream>
 #include <deque>
+#include <filesystem>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using namespace std;
@@ -88,11 +92,51 @@ namespace AdventOfCode2017
                 else
                 {
                     ref.type = referenceType::literalValue;
-                    ref.literalValue = stoi(token);
+                    if (ParseInt32(token, ref.literalValue).error != ParseError::None)
+                    {
+                        throw 1;
+                    }
+                }
+
+                return ref;
+            }
+
+            // The type tag and only the member it selects, so padding and
+            // the unused member never reach the cache.
+            static reference load(BinaryReader& reader)
+            {
+                reference ref;
+                ref.type = static_cast<referenceType>(reader.Read<int32_t>());
+                switch (ref.type)
+                {
+                case referenceType::registerName:
+                    ref.registerName = reader.Read<char>();
+                    break;
+                case referenceType::literalValue:
+                    ref.literalValue = reader.Read<int32_t>();
+                    break;
+                case referenceType::empty:
+                    break;
+                default:
+                    throw 1;
                 }
 
                 return ref;
             }
+
+            void save(BinaryWriter& writer) const
+            {
+                writer.Write(static_cast<int32_t>(type));
+                switch (type)
+                {
+                case referenceType::registerName:
+                    writer.Write(registerName);
+                    break;
+                case referenceType::literalValue:
+                    writer.Write(static_cast<int32_t>(literalValue));
+                    break;
+                }
+            }
         };
 
 
@@ -134,7 +178,22 @@ namespace AdventOfCode2017
 
                 stream >> skipws >> opCode >> operandA >> operandB;
 
-                return instruction(opCodes[opCode], reference::makeReference(operandA), reference::makeReference(operandB));
+                return instruction(opCodes.at(opCode), reference::makeReference(operandA), reference::makeReference(operandB));
+            }
+
+            static instruction load(BinaryReader& reader)
+            {
+                auto code = reader.Read<opCode>();
+                auto a = reference::load(reader);
+                auto b = reference::load(reader);
+                return instruction(code, a, b);
+            }
+
+            void save(BinaryWriter& writer) const
+            {
+                writer.Write(operation);
+                operandA.save(writer);
+                operandB.save(writer);
             }
 
             opCode getOpCode() const { return operation; }
@@ -363,9 +422,31 @@ namespace AdventOfCode2017
 
         static vector<instruction> makeProgram(const vector<string>& input)
         {
-            vector<instruction> instructions;
-            for_each(input.begin(), input.end(), [&instructions](const string& instr) { instructions.push_back(instruction::parseInstruction(instr)); });
-            return instructions;
+            return ParallelParse(input, instruction::parseInstruction);
+        }
+
+        static vector<instruction> makeCachedProgram(const vector<string>& input, const string& cacheFile)
+        {
+            return CachedParse(
+                HashLines(input),
+                cacheFile,
+                2,
+                [&input]() { return makeProgram(input); },
+                [](BinaryWriter& writer, const vector<instruction>& program)
+                {
+                    writer.Write(static_cast<uint64_t>(program.size()));
+                    for_each(program.begin(), program.end(), [&writer](const instruction& instr) { instr.save(writer); });
+                },
+                [](BinaryReader& reader)
+                {
+                    vector<instruction> program;
+                    auto count = reader.Read<uint64_t>();
+                    for (auto ii = uint64_t(0); ii < count; ii++)
+                    {
+                        program.push_back(instruction::load(reader));
+                    }
+                    return program;
+                });
         }
 
         static vector<string> exampleInput;
@@ -441,7 +522,7 @@ namespace AdventOfCode2017
 
         TEST_METHOD(Day18_2_Final)
         {
-            auto result = runMulticore(makeProgram(finalInput));
+            auto result = runMulticore(makeCachedProgram(finalInput, (filesystem::temp_directory_path() / "Day18.cache").string()));
             Assert::AreEqual(7239, static_cast<int>(result[1][core::sentCountRegName]));
         }
     };
@@ -34,7 +34,7 @@ namespace AdventOfCode2017
         class board
         {
         private:
-            vector<string> lines;
+            vector<string_view> lines;
 
             step keepGoingOrStop(int x, int y, step lastMove) const
             {
@@ -70,7 +70,7 @@ namespace AdventOfCode2017
             }
 
         public:
-            board(const vector<string>& input) : lines(input) { }
+            board(const vector<string_view>& input) : lines(input) { }
 
             step exitFrom(int x, int y, step lastMove) const
             {
@@ -175,8 +175,8 @@ namespace AdventOfCode2017
     public:
         TEST_METHOD(Day19_1_Test1)
         {
-            auto lines = ReadAllLines("C:\\Day19-sample.txt");
-            board theBoard(lines);
+            auto input = MappedInput("C:\\Day19-sample.txt");
+            board theBoard(input.Lines());
             Assert::AreEqual('|', theBoard.pieceAt(5, 0), L"normal read");
             Assert::AreEqual('A', theBoard.pieceAt(5, 2), L"normal read");
             Assert::AreEqual('+', theBoard.pieceAt(14, 3), L"normal read");
@@ -190,8 +190,8 @@ namespace AdventOfCode2017
 
         TEST_METHOD(Day19_1_Test2)
         {
-            auto lines = ReadAllLines("C:\\Day19-sample.txt");
-            board theBoard(lines);
+            auto input = MappedInput("C:\\Day19-sample.txt");
+            board theBoard(input.Lines());
             auto initial = theBoard.initialState();
 
             Assert::AreEqual(5, initial.x, L"x");
@@ -204,8 +204,8 @@ namespace AdventOfCode2017
 
         TEST_METHOD(Day19_1_Test3)
         {
-            auto lines = ReadAllLines("C:\\Day19-sample.txt");
-            board theBoard(lines);
+            auto input = MappedInput("C:\\Day19-sample.txt");
+            board theBoard(input.Lines());
             auto solution = theBoard.trace();
 
             Assert::AreEqual(1, solution.x, L"x");
@@ -216,10 +216,38 @@ namespace AdventOfCode2017
             Assert::AreEqual(38, solution.stepCount, L"steps");
         }
 
+        TEST_METHOD(Day19_1_Test4)
+        {
+            // The sample in memory, traced with and without the empty last
+            // line ReadAllLines used to return for a file ending in a
+            // newline; rows past the end already read as spaces.
+            vector<string_view> sample =
+            {
+                "     |          "sv,
+                "     |  +--+    "sv,
+                "     A  |  C    "sv,
+                " F---|----E|--+ "sv,
+                "     |  |  |  D "sv,
+                "     +B-+  +--+ "sv,
+            };
+
+            auto withEmptyLine = sample;
+            withEmptyLine.push_back(""sv);
+
+            for (auto& lines : { sample, withEmptyLine })
+            {
+                auto solution = board(lines).trace();
+                Assert::AreEqual(1, solution.x, L"x");
+                Assert::AreEqual(3, solution.y, L"y");
+                Assert::AreEqual("ABCDEF"s, *solution.trail);
+                Assert::AreEqual(38, solution.stepCount, L"steps");
+            }
+        }
+
         TEST_METHOD(Day19_1_Final)
         {
-            auto lines = ReadAllLines("C:\\Day19.txt");
-            board theBoard(lines);
+            auto input = MappedInput("C:\\Day19.txt");
+            board theBoard(input.Lines());
             auto solution = theBoard.trace();
 
             Assert::AreEqual(199, solution.x, L"x");
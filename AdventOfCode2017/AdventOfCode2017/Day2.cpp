@@ -1,7 +1,14 @@
 #include "stdafx.h"
 #include "CppUnitTest.h"
+#include "DivisiblePairs.h"
+#include "Spreadsheet.h"
 #include <vector>
 #include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include <filesystem>
+#include <string>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -48,7 +55,7 @@ namespace AdventOfCode2017
         {
             auto sum = 0;
             
-            auto accumulateChecksum = [&sum](auto row)
+            auto accumulateChecksum = [&sum](const auto& row)
             {
                 auto minmax = std::minmax_element(row.begin(), row.end());
                 sum += *(minmax.second) - *(minmax.first);
@@ -59,24 +66,18 @@ namespace AdventOfCode2017
             return sum;
         }
 
+        int Checksum(const Spreadsheet& input)
+        {
+            return static_cast<int>(SpreadsheetChecksum(input));
+        }
+
         int SumDivisible(const std::vector<std::vector<int>>& input)
         {
             auto sum = 0;
 
-            auto accumulate = [&sum](auto row)
+            auto accumulate = [&sum](const auto& row)
             {
-                for (auto ii = size_t(0); ii < row.size(); ii++)
-                {
-                    for (auto jj = ii + 1; jj < row.size(); jj++)
-                    {
-                        auto sorted = std::minmax(row[ii], row[jj]);
-                        if (sorted.second % sorted.first == 0)
-                        {
-                            sum += sorted.second / sorted.first;
-                            return;
-                        }
-                    }
-                }
+                sum += DivisibleQuotient(row.data(), row.size());
             };
 
             std::for_each(input.begin(), input.end(), accumulate);
@@ -84,15 +85,96 @@ namespace AdventOfCode2017
             return sum;
         }
 
+        int SumDivisible(const Spreadsheet& input)
+        {
+            return static_cast<int>(SpreadsheetSumDivisible(input));
+        }
+
     public:
         TEST_METHOD(Day2_1_Test1)
         {
             Assert::AreEqual(18, Checksum(TestData1));
         }
 
+        TEST_METHOD(Day2_1_Test2)
+        {
+            auto seed = 777u;
+            auto next = [&seed]() { seed = seed * 1103515245u + 12345u; return seed >> 8; };
+
+            // Ragged rows, including empty ones, large enough to be split
+            // into several chunks.
+            Spreadsheet mixed;
+            Spreadsheet positive;
+            auto expectedChecksum = int64_t(0);
+            auto expectedDivisible = int64_t(0);
+
+            for (auto row = 0; row < 1000; row++)
+            {
+                std::vector<int> values(next() % 600);
+                for (auto& value : values)
+                {
+                    value = static_cast<int>(next() % 200000) - 100000;
+                }
+
+                if (!values.empty())
+                {
+                    auto minmax = std::minmax_element(values.begin(), values.end());
+                    expectedChecksum += *minmax.second - *minmax.first;
+                }
+
+                mixed.AddRow(values.data(), values.size());
+
+                for (auto& value : values)
+                {
+                    value = std::abs(value) + 1;
+                }
+
+                expectedDivisible += PairwiseDivisibleQuotient(values.data(), values.size());
+                positive.AddRow(values.data(), values.size());
+            }
+
+            ThreadPool pool(4);
+            Assert::AreEqual(size_t(1000), mixed.RowCount());
+
+            for (auto level = 0; level <= static_cast<int>(DetectSimdLevel()); level++)
+            {
+                Assert::AreEqual(expectedChecksum, SpreadsheetChecksum(mixed, pool, static_cast<SimdLevel>(level)));
+            }
+
+            Assert::AreEqual(expectedDivisible, SpreadsheetSumDivisible(positive, pool));
+        }
+
+        TEST_METHOD(Day2_1_Test3)
+        {
+            const auto fileName = (std::filesystem::temp_directory_path() / "Day2-stream.tsv").string();
+
+            {
+                std::ofstream output(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+                for (auto& row : FinalData)
+                {
+                    for (auto ii = size_t(0); ii < row.size(); ii++)
+                    {
+                        output << (ii == 0 ? "" : "\t") << row[ii];
+                    }
+
+                    output << "\r\n";
+                }
+
+                output << "\r\n";
+            }
+
+            auto totals = StreamSpreadsheet(fileName);
+            std::remove(fileName.c_str());
+
+            Assert::AreEqual(FinalData.size(), totals.rows);
+            Assert::AreEqual(int64_t(48357), totals.checksum);
+            Assert::AreEqual(int64_t(351), totals.divisible);
+        }
+
         TEST_METHOD(Day2_1_Final)
         {
             Assert::AreEqual(48357, Checksum(FinalData));
+            Assert::AreEqual(48357, Checksum(Spreadsheet(FinalData)));
         }
 
         TEST_METHOD(Day2_2_Test1)
@@ -100,9 +182,137 @@ namespace AdventOfCode2017
             Assert::AreEqual(9, SumDivisible(TestData2));
         }
 
+        TEST_METHOD(Day2_2_Test2)
+        {
+            // Small values give rows with repeats and several divisible pairs;
+            // huge ones push the lookup from the bitset to the hash table.
+            auto seed = 12345u;
+            auto next = [&seed]() { seed = seed * 1103515245u + 12345u; return seed >> 8; };
+
+            for (auto trial = 0; trial < 2000; trial++)
+            {
+                auto huge = trial % 2 == 1;
+                std::vector<int> row(next() % 40);
+
+                for (auto& value : row)
+                {
+                    value = huge ? static_cast<int>(next() % 2000000000u) + 1 : static_cast<int>(next() % 60) + 1;
+                }
+
+                if (huge && row.size() >= 2)
+                {
+                    row[next() % row.size()] = row[next() % row.size()] / 7 + 1;
+                }
+
+                Assert::AreEqual(PairwiseDivisibleQuotient(row.data(), row.size()), DivisibleQuotient(row.data(), row.size()));
+            }
+
+            std::vector<int> withZero = { 4, 0, 8, -2 };
+            Assert::AreEqual(PairwiseDivisibleQuotient(withZero.data() + 2, 2), DivisibleQuotient(withZero.data() + 2, 2));
+        }
+
+        TEST_METHOD(Day2_2_Test3)
+        {
+            // No two values in [500000, 1000000) divide each other, and none
+            // of these are multiples of 3, so the only pair is 3 and 600000.
+            std::vector<int> row;
+            for (auto ii = 0; ii < 100000; ii++)
+            {
+                row.push_back(500002 + 3 * ii);
+            }
+
+            row.insert(row.begin() + 50000, 3);
+            row.push_back(600000);
+
+            Assert::AreEqual(200000, DivisibleQuotient(row.data(), row.size()));
+        }
+
+        TEST_METHOD(Day2_2_Test4)
+        {
+            auto seed = 4242u;
+            auto next = [&seed]() { seed = seed * 1103515245u + 12345u; return seed >> 8; };
+
+            for (auto level = 0; level <= static_cast<int>(DetectSimdLevel()); level++)
+            {
+                for (auto trial = 0; trial < 1000; trial++)
+                {
+                    // Large values exercise the full 32-bit range of the test,
+                    // small ones give rows with several pairs.
+                    auto range = trial % 3 == 0 ? 2147483647u : trial % 3 == 1 ? 100000u : 50u;
+                    std::vector<int> row(next() % 50);
+
+                    for (auto& value : row)
+                    {
+                        value = static_cast<int>((next() * 2654435761u) % range) + 1;
+                    }
+
+                    Assert::AreEqual(PairwiseDivisibleQuotient(row.data(), row.size()), DivisionFreeQuotient(row.data(), row.size(), static_cast<SimdLevel>(level)));
+                }
+            }
+
+            auto sum = 0;
+            for (auto& row : FinalData)
+            {
+                sum += DivisionFreeQuotient(row.data(), row.size());
+            }
+
+            Assert::AreEqual(351, sum);
+        }
+
+        TEST_METHOD(Day2_2_Test5)
+        {
+            // Rows of large values far apart, so every one goes through the
+            // hash table, streamed against the pairwise scan.
+            const auto fileName = (std::filesystem::temp_directory_path() / "Day2-sparse.tsv").string();
+
+            auto seed = 777u;
+            auto next = [&seed]() { seed = seed * 1103515245u + 12345u; return seed >> 8; };
+
+            auto checksum = int64_t(0);
+            auto divisible = int64_t(0);
+            auto rows = size_t(0);
+
+            {
+                std::ofstream output(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+                for (auto trial = 0; trial < 500; trial++)
+                {
+                    std::vector<int> row(next() % 60 + 2);
+                    for (auto& value : row)
+                    {
+                        value = static_cast<int>((next() * 2654435761u) % 2000000000u) + 100000;
+                    }
+
+                    if (trial % 2 == 0)
+                    {
+                        row[next() % row.size()] = row[next() % row.size()] / 11 + 1;
+                    }
+
+                    for (auto ii = size_t(0); ii < row.size(); ii++)
+                    {
+                        output << (ii == 0 ? "" : "\t") << row[ii];
+                    }
+
+                    output << "\n";
+
+                    auto minmax = std::minmax_element(row.begin(), row.end());
+                    checksum += int64_t(*minmax.second) - *minmax.first;
+                    divisible += PairwiseDivisibleQuotient(row.data(), row.size());
+                    rows++;
+                }
+            }
+
+            auto totals = StreamSpreadsheet(fileName);
+            std::remove(fileName.c_str());
+
+            Assert::AreEqual(rows, totals.rows);
+            Assert::AreEqual(checksum, totals.checksum);
+            Assert::AreEqual(divisible, totals.divisible);
+        }
+
         TEST_METHOD(Day2_2_Final)
         {
             Assert::AreEqual(351, SumDivisible(FinalData));
+            Assert::AreEqual(351, SumDivisible(Spreadsheet(FinalData)));
         }
     };
 }
\ No newline at end of file
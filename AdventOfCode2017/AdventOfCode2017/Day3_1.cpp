@@ -1,5 +1,7 @@
 #include "stdafx.h"
 #include "CppUnitTest.h"
+#include "Spiral.h"
+#include <vector>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -9,6 +11,13 @@ namespace AdventOfCode2017
     {
     private:
         std::pair<int, int> FindCoordinates(int cell)
+        {
+            auto coordinates = SpiralCoordinates(cell);
+            return std::make_pair(static_cast<int>(coordinates.first), static_cast<int>(coordinates.second));
+        }
+
+        // The original step-by-step walk, kept to check SpiralCoordinates.
+        std::pair<int, int> WalkCoordinates(int cell)
         {
             auto x = 0;
             auto y = 0;
@@ -67,6 +76,66 @@ namespace AdventOfCode2017
             Assert::AreEqual(31, TaxiDistance(FindCoordinates(1024)));
         }
 
+        TEST_METHOD(Day3_1_Test5)
+        {
+            for (auto cell = 1; cell <= 100000; cell++)
+            {
+                auto expected = WalkCoordinates(cell);
+                Assert::IsTrue(expected == FindCoordinates(cell));
+                Assert::AreEqual(uint64_t(cell), SpiralIndex(expected.first, expected.second));
+            }
+        }
+
+        TEST_METHOD(Day3_1_Test6)
+        {
+            // Ring k ends at (k, -k) on square (2k + 1)^2, with the ring's
+            // other corners 2k squares apart before it.
+            auto ring = int64_t(1000000000);
+            auto last = uint64_t(2 * ring + 1) * uint64_t(2 * ring + 1);
+            auto side = uint64_t(2 * ring);
+
+            Assert::IsTrue(std::make_pair(ring, -ring) == SpiralCoordinates(last));
+            Assert::IsTrue(std::make_pair(-ring, -ring) == SpiralCoordinates(last - side));
+            Assert::IsTrue(std::make_pair(-ring, ring) == SpiralCoordinates(last - 2 * side));
+            Assert::IsTrue(std::make_pair(ring, ring) == SpiralCoordinates(last - 3 * side));
+            Assert::IsTrue(std::make_pair(ring + 1, -ring) == SpiralCoordinates(last + 1));
+
+            for (auto index = last - 3 * side - 5; index < last + 5; index += 997)
+            {
+                auto coordinates = SpiralCoordinates(index);
+                Assert::AreEqual(index, SpiralIndex(coordinates.first, coordinates.second));
+            }
+        }
+
+        TEST_METHOD(Day3_1_Test7)
+        {
+            const size_t count = 4099;
+            std::vector<uint64_t> indices(count);
+            for (auto ii = size_t(0); ii < count; ii++)
+            {
+                indices[ii] = uint64_t(1) + ii * ii * 7919;
+            }
+
+            indices[1] = uint64_t(1) << 62;
+            indices[2] = (uint64_t(1) << 62) - 1;
+
+            for (auto level = 0; level <= static_cast<int>(DetectSimdLevel()); level++)
+            {
+                std::vector<int64_t> xs(count);
+                std::vector<int64_t> ys(count);
+                SpiralCoordinates(indices.data(), count, xs.data(), ys.data(), static_cast<SimdLevel>(level));
+
+                std::vector<uint64_t> roundTrip(count);
+                SpiralIndices(xs.data(), ys.data(), count, roundTrip.data(), static_cast<SimdLevel>(level));
+
+                for (auto ii = size_t(0); ii < count; ii++)
+                {
+                    Assert::IsTrue(std::make_pair(xs[ii], ys[ii]) == SpiralCoordinates(indices[ii]));
+                    Assert::AreEqual(indices[ii], roundTrip[ii]);
+                }
+            }
+        }
+
         TEST_METHOD(Day3_1_Final)
         {
             Assert::AreEqual(438, TaxiDistance(FindCoordinates(265149)));
@@ -1,6 +1,8 @@
 #include "stdafx.h"
 #include "CppUnitTest.h"
-#include <map>
+#include "Spiral.h"
+#include "Utilities.h"
+#include <vector>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -9,119 +11,70 @@ namespace AdventOfCode2017
     TEST_CLASS(Day3_2)
     {
     private:
-        static int FindTestValue(int x, int y, std::map<std::pair<int, int>, int>& values)
+        struct FindTestValue
         {
-            auto total = 0;
-
-            for (auto ii = x - 1; ii <= x + 1; ii++)
+            template<class Value>
+            Value operator()(Value total, Value neighbour) const
             {
-                for (auto jj = y - 1; jj <= y + 1; jj++)
-                {
-                    auto iter = values.find(std::make_pair(ii, jj));
-
-                    if (iter != values.end())
-                    {
-                        total += iter->second;
-                    }
-                }
+                return total + neighbour;
             }
-
-            values[std::make_pair(x, y)] = total;
-
-            return total;
-        }
-
-        static int NullValue(int, int, std::map<std::pair<int, int>, int>&)
-        {
-            return 0;
-        }
+        };
 
         static int TaxiDistance(const std::pair<int, int>& coordinates)
         {
             return abs(coordinates.first) + abs(coordinates.second);
         }
 
-        class state
+        // The neighbour sums of the first count squares, found by looking up
+        // each neighbour's index, to check SpiralRings against.
+        static std::vector<uint64_t> ReferenceValues(size_t count)
         {
-        private:
-            int x;
-            int y;
-            int len;
-            int side;
-            bool inc;
-            bool countingX;
-            std::map<std::pair<int, int>, int> values;
-            int(*UpdateValueSpace)(int, int, std::map<std::pair<int, int>, int>&);
-
-        public:
-            state(int(*updateValueSpace)(int, int, std::map<std::pair<int, int>, int>&), int initialValue)
-            {
-                x = 0;
-                y = 0;
-                len = 0;
-                side = 1;
-                inc = true;
-                countingX = true;
-
-                values[std::make_pair(0, 0)] = initialValue;
-                UpdateValueSpace = updateValueSpace;
-            }
+            std::vector<uint64_t> values(count + 1, 0);
+            values[1] = 1;
 
-            int ComputeNextValue()
+            for (auto index = uint64_t(2); index <= count; index++)
             {
-                if (len >= side)
+                auto coordinates = SpiralCoordinates(index);
+                for (auto dx = -1; dx <= 1; dx++)
                 {
-                    len = 0;
-                    countingX = !countingX;
-                    if (countingX)
+                    for (auto dy = -1; dy <= 1; dy++)
                     {
-                        side++;
-                        inc = !inc;
+                        auto neighbour = SpiralIndex(coordinates.first + dx, coordinates.second + dy);
+                        if (neighbour < index)
+                        {
+                            values[index] += values[neighbour];
+                        }
                     }
                 }
-
-                int& coordinate = countingX ? x : y;
-                coordinate += inc ? 1 : -1;
-                len++;
-
-                auto newValue = UpdateValueSpace(x, y, values);
-
-                return newValue;
             }
 
-            std::pair<int, int> currentCoordinates() const
-            {
-                return std::make_pair(x, y);
-            }
-        };
+            return values;
+        }
 
         std::pair<int, int> FindCoordinates(int cell)
         {
-            state s(NullValue, 0);
-            for (auto current = 1; current < cell; current++)
-            {
-                s.ComputeNextValue();
-            }
-            return s.currentCoordinates();
+            auto coordinates = SpiralCoordinates(cell);
+            return std::make_pair(static_cast<int>(coordinates.first), static_cast<int>(coordinates.second));
         }
 
         int FindMemoryTestPattern(int cell)
         {
-            state s(FindTestValue, 1);
-            int value = 1;
+            SpiralRings<int64_t, FindTestValue> s(1);
+            auto value = int64_t(1);
             for (auto current = 1; current < cell; current++)
             {
-                value = s.ComputeNextValue();
+                value = s.Next();
             }
-            return value;
+            return static_cast<int>(value);
         }
 
-        int FindTestValueThreshold(int threshold)
+        template<class Value>
+        Value FindTestValueThreshold(Value threshold)
         {
-            state s(FindTestValue, 1);
+            SpiralRings<Value, FindTestValue> s(Value{ 1 });
             while (true)
             {
-                auto value = s.ComputeNextValue();
+                auto value = s.Next();
 
                 if (value > threshold)
                 {
@@ -191,6 +144,41 @@ namespace AdventOfCode2017
             Assert::AreEqual(122, FindTestValueThreshold(100));
         }
 
+        TEST_METHOD(Day3_2_Test8)
+        {
+            const size_t count = 20000;
+            auto expected = ReferenceValues(count);
+
+            SpiralRings<uint64_t, FindTestValue> s(1);
+            for (auto index = size_t(2); index <= count; index++)
+            {
+                Assert::AreEqual(expected[index], s.Next());
+            }
+        }
+
+        TEST_METHOD(Day3_2_Test9)
+        {
+            // Both types wrap, so the low half of the 128-bit values follows
+            // the 64-bit ones all the way, long after they overflow.
+            SpiralRings<uint64_t, FindTestValue> narrow(1);
+            SpiralRings<UInt128, FindTestValue> wide(UInt128{ 1 });
+            auto overflowed = false;
+            for (auto index = 2; index <= 5000; index++)
+            {
+                auto value = narrow.Next();
+                auto wideValue = wide.Next();
+                Assert::AreEqual(value, wideValue.low);
+
+                overflowed = overflowed || wideValue.high != 0;
+                Assert::AreEqual(overflowed, UInt128{ value } < wideValue);
+            }
+
+            auto threshold = UInt128{ 0, 1 };
+            auto value = FindTestValueThreshold(threshold);
+            Assert::IsTrue(value > threshold);
+            Assert::AreEqual(uint64_t(1), value.high);
+        }
+
         TEST_METHOD(Day3_2_Final)
         {
             Assert::AreEqual(266330, FindTestValueThreshold(265149));
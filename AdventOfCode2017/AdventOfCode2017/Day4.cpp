@@ -1,10 +1,19 @@
 #include "stdafx.h"
 #include "CppUnitTest.h"
 #include "Utilities.h"
+#include "Passphrase.h"
+#include "AnagramIndex.h"
+#include "Tokenizer.h"
 #include <vector>
 #include <set>
+#include <map>
 #include <fstream>
+#include <filesystem>
 #include <algorithm>
+#include <random>
+#include <type_traits>
+#include <chrono>
+#include <cstdio>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -13,33 +22,12 @@ namespace AdventOfCode2017
     TEST_CLASS(Day4)
     {
     private:
-        static std::vector<std::string> TokenizeString(const std::string& string)
+        static std::vector<std::string_view> TokenizeString(std::string_view string)
         {
-            std::vector<std::string> result;
-
-            std::string buffer;
-            for (auto iter = string.begin(); iter != string.end(); iter++)
-            {
-                switch (*iter)
-                {
-                case ' ':
-                case '\n':
-                case '\r':
-                    if (!buffer.empty())
-                    {
-                        result.push_back(buffer);
-                        buffer.clear();
-                    }
-                    break;
-                default:
-                    buffer.push_back(*iter);
-                    break;
-                }
-            }
-
-            if (!buffer.empty())
+            std::vector<std::string_view> result;
+            for (auto token : Tokenizer(string, " \r\n"))
             {
-                result.push_back(buffer);
+                result.push_back(token);
             }
 
             return result;
@@ -60,10 +48,22 @@ namespace AdventOfCode2017
         };
 
         template<class Comp=std::less<std::string>>
-        static bool IsValidPassphrase(const std::string& phrase)
+        static bool IsValidPassphrase(std::string_view phrase)
+        {
+            auto rule = std::is_same<Comp, CompareAnagrams>::value ? PassphraseRule::NoAnagrams : PassphraseRule::NoDuplicates;
+            return AdventOfCode2017::IsValidPassphrase(phrase, rule);
+        }
+
+        // The original set-based check, kept to compare the validator with.
+        template<class Comp=std::less<std::string>>
+        static bool IsValidBySet(std::string_view phrase)
         {
             auto words = TokenizeString(phrase);
-            std::set<std::string, Comp> uniqueWords(words.begin(), words.end());
+            std::set<std::string, Comp> uniqueWords;
+            for (auto& word : words)
+            {
+                uniqueWords.emplace(word);
+            }
             return words.size() == uniqueWords.size();
         }
 
@@ -73,10 +73,10 @@ namespace AdventOfCode2017
         {
             auto result = TokenizeString("elem1   e2  word3 four\n");
             Assert::AreEqual(size_t(4), result.size());
-            Assert::AreEqual("elem1", result[0].data());
-            Assert::AreEqual("e2", result[1].data());
-            Assert::AreEqual("word3", result[2].data());
-            Assert::AreEqual("four", result[3].data());
+            Assert::IsTrue(result[0] == "elem1");
+            Assert::IsTrue(result[1] == "e2");
+            Assert::IsTrue(result[2] == "word3");
+            Assert::IsTrue(result[3] == "four");
         }
 
         TEST_METHOD(Day4_1_Test2)
@@ -101,7 +101,8 @@ namespace AdventOfCode2017
 
         TEST_METHOD(Day4_1_Final)
         {
-            auto lines = ReadAllLines("C:\\Day4.txt");
+            auto input = MappedInput("C:\\Day4.txt");
+            auto& lines = input.Lines();
             Assert::AreEqual(size_t(512), lines.size());
 
             auto count = 0;
@@ -140,9 +141,227 @@ namespace AdventOfCode2017
             Assert::IsFalse(IsValidPassphrase<CompareAnagrams>("oiii ioii iioi iiio"));
         }
 
+        TEST_METHOD(Day4_2_Test6)
+        {
+            // A small alphabet makes repeats and anagrams common. Some lines
+            // outgrow the stack table, and some words have capitals or are
+            // too long for an exact signature.
+            std::mt19937 random(4);
+            std::uniform_int_distribution<int> letters(0, 3);
+            std::uniform_int_distribution<int> lengths(1, 4);
+            std::uniform_int_distribution<int> counts(1, 100);
+
+            for (auto line = 0; line < 2000; line++)
+            {
+                std::string phrase;
+                auto words = line % 10 == 0 ? 200 : counts(random) % 12 + 1;
+                for (auto word = 0; word < words; word++)
+                {
+                    auto length = line % 7 == 0 ? 30 + lengths(random) : lengths(random) + word % 3;
+                    for (auto ii = 0; ii < length; ii++)
+                    {
+                        phrase.push_back(static_cast<char>((line % 5 == 0 ? 'A' : 'a') + letters(random) + (word % 11 == 0 ? word : 0)));
+                    }
+                    phrase.append(word % 4 == 3 ? "\r\n" : " ");
+                }
+
+                Assert::AreEqual(IsValidBySet(phrase), IsValidPassphrase(phrase));
+                Assert::AreEqual(IsValidBySet<CompareAnagrams>(phrase), IsValidPassphrase<CompareAnagrams>(phrase));
+            }
+        }
+
+        TEST_METHOD(Day4_2_Test7)
+        {
+            // Line lengths around the 64-byte blocks, blank lines, CRLF
+            // endings, runs of spaces and a missing final newline.
+            std::mt19937 random(7);
+            std::uniform_int_distribution<int> letters(0, 4);
+            std::uniform_int_distribution<int> lengths(0, 9);
+
+            std::string contents;
+            for (auto line = 0; line < 3000; line++)
+            {
+                auto words = lengths(random) + (line % 50 == 0 ? 80 : 0);
+                for (auto word = 0; word < words; word++)
+                {
+                    contents.append(lengths(random) % 3 == 0 ? "  " : " ");
+                    for (auto ii = lengths(random) / 2; ii >= 0; ii--)
+                    {
+                        contents.push_back(static_cast<char>('a' + letters(random)));
+                    }
+                }
+                contents.append(line % 3 == 0 ? "\r\n" : "\n");
+            }
+            contents.append("ab ba");
+
+            auto lines = SplitLines(contents);
+            auto distinct = size_t(0);
+            auto noAnagrams = size_t(0);
+            for (auto& line : lines)
+            {
+                distinct += IsValidPassphrase(line) ? 1 : 0;
+                noAnagrams += IsValidPassphrase<CompareAnagrams>(line) ? 1 : 0;
+            }
+
+            for (auto level = 0; level <= static_cast<int>(DetectSimdLevel()); level++)
+            {
+                for (auto threads : { size_t(1), size_t(4) })
+                {
+                    ThreadPool pool(threads);
+                    for (auto length = contents.size() - 130; length <= contents.size(); length += 13)
+                    {
+                        auto prefix = std::string_view(contents).substr(0, length);
+                        auto counts = CountValidPassphrases(prefix, pool, static_cast<SimdLevel>(level));
+                        if (length == contents.size())
+                        {
+                            Assert::AreEqual(lines.size(), counts.lines);
+                            Assert::AreEqual(distinct, counts.noDuplicates);
+                            Assert::AreEqual(noAnagrams, counts.noAnagrams);
+                        }
+                        else
+                        {
+                            Assert::AreEqual(SplitLines(prefix).size(), counts.lines);
+                        }
+                    }
+                }
+            }
+        }
+
+        TEST_METHOD(Day4_2_Test8)
+        {
+            auto input = MappedInput("C:\\Day4.txt");
+            auto counts = CountValidPassphrases(input.Contents());
+            Assert::AreEqual(size_t(512), counts.lines);
+            Assert::AreEqual(size_t(383), counts.noDuplicates);
+            Assert::AreEqual(size_t(265), counts.noAnagrams);
+
+            // Throughput over the puzzle input repeated to about 64 MiB.
+            std::string corpus;
+            while (corpus.size() < 64 * 1024 * 1024)
+            {
+                corpus.append(input.Contents());
+                corpus.push_back('\n');
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            counts = CountValidPassphrases(corpus);
+            auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            Assert::AreEqual(counts.lines / 512 * 265, counts.noAnagrams);
+
+            char message[128];
+            snprintf(message, sizeof(message), "%.0f lines/s, %.0f MB/s", counts.lines / seconds, corpus.size() / seconds / 1e6);
+            Logger::WriteMessage(message);
+        }
+
+        TEST_METHOD(Day4_2_Test9)
+        {
+            auto input = MappedInput("C:\\Day4.txt");
+            auto& lines = input.Lines();
+
+            // Every word's class, found by sorting, with the lines it is on.
+            std::map<std::string, std::vector<uint32_t>> expected;
+            for (auto line = size_t(0); line < lines.size(); line++)
+            {
+                for (auto& word : TokenizeString(lines[line]))
+                {
+                    auto key = std::string(word);
+                    std::sort(key.begin(), key.end());
+                    auto& postings = expected[key];
+                    if (postings.empty() || postings.back() != line)
+                    {
+                        postings.push_back(static_cast<uint32_t>(line));
+                    }
+                }
+            }
+
+            auto check = [&expected, &lines](const AnagramIndex& index)
+            {
+                Assert::AreEqual(lines.size(), index.LineCount());
+                Assert::AreEqual(expected.size(), index.ClassCount());
+
+                for (auto& entry : expected)
+                {
+                    auto word = entry.first;
+                    std::reverse(word.begin(), word.end());
+                    auto found = index.LinesWithAnagram(word);
+                    Assert::IsTrue(std::equal(found.begin(), found.end(), entry.second.begin(), entry.second.end()));
+                }
+
+                Assert::IsTrue(index.LinesWithAnagram("notaword").empty());
+                Assert::IsTrue(index.LinesWithAnagram("").empty());
+            };
+
+            for (auto threads : { size_t(1), size_t(4) })
+            {
+                ThreadPool pool(threads);
+                check(AnagramIndex(input.Contents(), pool));
+            }
+
+            const auto fileName = (std::filesystem::temp_directory_path() / "Day4-anagrams.idx").string();
+            AnagramIndex(input.Contents()).Save(fileName);
+            {
+                auto opened = AnagramIndex::Open(fileName);
+                check(opened);
+
+                auto start = std::chrono::steady_clock::now();
+                auto found = size_t(0);
+                for (auto ii = 0; ii < 100; ii++)
+                {
+                    for (auto& entry : expected)
+                    {
+                        found += opened.LinesWithAnagram(entry.first).size();
+                    }
+                }
+                auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                char message[128];
+                snprintf(message, sizeof(message), "%.3f us per anagram query", seconds * 1e6 / (100 * expected.size()));
+                Logger::WriteMessage(message);
+                Assert::IsTrue(found > 0);
+            }
+            std::remove(fileName.c_str());
+
+            // A truncated file is refused.
+            {
+                std::ofstream output(fileName, std::ios::binary);
+                output << "AIDX";
+            }
+            auto threw = false;
+            try
+            {
+                AnagramIndex::Open(fileName);
+            }
+            catch (int)
+            {
+                threw = true;
+            }
+            std::remove(fileName.c_str());
+            Assert::IsTrue(threw);
+
+            // So is one whose slots are all taken, where a missing word
+            // would be probed for forever: one class, filling both slots.
+            {
+                const uint32_t full[] = { 0x58444941, 1, 0, 1, 2, 0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0 };
+                std::ofstream output(fileName, std::ios::binary);
+                output.write(reinterpret_cast<const char*>(full), sizeof(full));
+            }
+            threw = false;
+            try
+            {
+                AnagramIndex::Open(fileName);
+            }
+            catch (int)
+            {
+                threw = true;
+            }
+            std::remove(fileName.c_str());
+            Assert::IsTrue(threw);
+        }
+
         TEST_METHOD(Day4_2_Final)
         {
-            auto lines = ReadAllLines("C:\\Day4.txt");
+            auto input = MappedInput("C:\\Day4.txt");
+            auto& lines = input.Lines();
             Assert::AreEqual(size_t(512), lines.size());
 
             auto count = 0;
@@ -1,8 +1,15 @@
 #include "stdafx.h"
 #include "CppUnitTest.h"
 #include "Utilities.h"
+#include "ParseInt.h"
+#include "JumpMaze.h"
 #include <vector>
 #include <algorithm>
+#include <string_view>
+#include <cstdint>
+#include <random>
+#include <chrono>
+#include <cstdio>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -11,17 +18,23 @@ namespace AdventOfCode2017
     TEST_CLASS(Day5)
     {
     private:
-        std::vector<int> ConvertToInt(const std::vector<std::string>& input)
+        template<class Lines>
+        std::vector<int> ConvertToInt(Lines&& input)
         {
             std::vector<int> output;
-            output.resize(input.size());
 
-            auto toInt = [](const std::string& str)
+            auto toInt = [](std::string_view str)
             {
-                return std::stoi(str);
+                int value;
+                if (ParseInt32(str, value).error != ParseError::None)
+                {
+                    throw 1;
+                }
+
+                return value;
             };
 
-            std::transform(input.begin(), input.end(), output.begin(), toInt);
+            std::transform(input.begin(), input.end(), std::back_inserter(output), toInt);
 
             return output;
         }
@@ -64,6 +77,8 @@ namespace AdventOfCode2017
 
             int Moves() const { return moves; }
 
+            const std::vector<int>& Jumps() const { return jumps; }
+
             int Solve()
             {
                 while (!IsEscaped())
@@ -96,8 +111,7 @@ namespace AdventOfCode2017
 
         TEST_METHOD(Day5_1_Final)
         {
-            auto raw = ReadAllLines("C:\\Day5.txt");
-            auto input = ConvertToInt(raw);
+            auto input = ConvertToInt(LineReader("C:\\Day5.txt"));
             Assert::AreEqual(351282, state<>(input).Solve());
         }
 
@@ -107,11 +121,162 @@ namespace AdventOfCode2017
             Assert::AreEqual(10, state<Part2Update>(input).Solve());
         }
 
+        TEST_METHOD(Day5_2_Test2)
+        {
+            std::vector<int> input = { 0, 3, 0, 1, -3, };
+            Assert::IsTrue(SolveStrangeJumps(input) == 10);
+            Assert::IsTrue(input == std::vector<int>({ 2, 3, 2, 3, -1, }));
+
+            std::vector<int> empty;
+            Assert::IsTrue(SolveStrangeJumps(empty) == 0);
+        }
+
+        TEST_METHOD(Day5_2_Test3)
+        {
+            // Random mazes against state<>, with offsets that fit each of
+            // the cell widths. The wide ones have a few far jumps among
+            // short ones so that they still run for a while.
+            std::mt19937 random(5);
+            const int ranges[][2] = { { -3, 3 }, { -40, 20 }, { -127, 127 }, { -128, 100 }, { -300, 200 }, { -40000, 40000 } };
+
+            for (auto& range : ranges)
+            {
+                std::uniform_int_distribution<int> offsets(range[0], range[1]);
+                std::uniform_int_distribution<int> shortOffsets(-6, 4);
+                for (auto size = size_t(1); size < 400; size += 7)
+                {
+                    std::vector<int> input(size);
+                    for (auto ii = size_t(0); ii < size; ii++)
+                    {
+                        auto offset = range[1] - range[0] > 500 && ii % 16 != 5 ? shortOffsets(random) : offsets(random);
+                        input[ii] = std::max(offset, -static_cast<int>(ii));
+                    }
+
+                    state<Part2Update> expected(input);
+                    auto moves = expected.Solve();
+
+                    Assert::IsTrue(SolveStrangeJumps(input) == uint64_t(moves));
+                    Assert::IsTrue(input == expected.Jumps());
+                }
+            }
+        }
+
+        TEST_METHOD(Day5_2_Test4)
+        {
+            // A million cells, already 2s and 3s but for the last thousand,
+            // which jump back as far as a thousand cells past their own
+            // place in that thousand, as the puzzle input does.
+            std::mt19937 random(11);
+            std::uniform_int_distribution<int> settled(2, 3);
+            std::vector<int> input(1000000);
+            for (auto ii = size_t(0); ii < input.size(); ii++)
+            {
+                auto tail = static_cast<int>(ii) - static_cast<int>(input.size() - 1000);
+                input[ii] = tail < 0 ? settled(random) : std::uniform_int_distribution<int>(-(tail + 1000), 2)(random);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            state<Part2Update> expected(input);
+            auto moves = expected.Solve();
+            auto middle = std::chrono::steady_clock::now();
+            auto fastMoves = SolveStrangeJumps(input);
+            auto end = std::chrono::steady_clock::now();
+
+            Assert::IsTrue(fastMoves == uint64_t(moves));
+            Assert::IsTrue(input == expected.Jumps());
+
+            char message[128];
+            snprintf(
+                message,
+                sizeof(message),
+                "%.0f jumps: %.3f s a jump at a time, %.3f s settled",
+                double(fastMoves),
+                std::chrono::duration<double>(middle - start).count(),
+                std::chrono::duration<double>(end - middle).count());
+            Logger::WriteMessage(message);
+        }
+
+        TEST_METHOD(Day5_2_Test5)
+        {
+            // Batches with empty mazes, mazes left on the first jump and
+            // more mazes than lanes, against state<> under both rules.
+            std::mt19937 random(22);
+            std::uniform_int_distribution<int> sizes(0, 60);
+            std::uniform_int_distribution<int> offsets(-30, 4);
+
+            for (auto batch = 0; batch < 20; batch++)
+            {
+                std::vector<std::vector<int>> mazes(batch * 3);
+                for (auto& maze : mazes)
+                {
+                    maze.resize(sizes(random));
+                    for (auto ii = size_t(0); ii < maze.size(); ii++)
+                    {
+                        maze[ii] = batch % 4 == 0 ? offsets(random) : std::max(offsets(random), -static_cast<int>(ii));
+                    }
+                }
+
+                for (auto level = 0; level <= static_cast<int>(DetectSimdLevel()); level++)
+                {
+                    auto simdLevel = static_cast<SimdLevel>(level);
+                    auto plain = SolveJumpMazes<IncrementJump>(mazes, simdLevel);
+                    auto strange = SolveJumpMazes<StrangeJump>(mazes, simdLevel);
+                    Assert::AreEqual(mazes.size(), plain.size());
+                    Assert::AreEqual(mazes.size(), strange.size());
+
+                    for (auto ii = size_t(0); ii < mazes.size(); ii++)
+                    {
+                        Assert::IsTrue(plain[ii] == uint64_t(state<>(mazes[ii]).Solve()));
+                        Assert::IsTrue(strange[ii] == uint64_t(state<Part2Update>(mazes[ii]).Solve()));
+                    }
+                }
+            }
+        }
+
+        TEST_METHOD(Day5_2_Test6)
+        {
+            // Two thousand small mazes shaped like the puzzle input.
+            std::mt19937 random(23);
+            std::uniform_int_distribution<int> sizes(60, 160);
+            std::vector<std::vector<int>> mazes(2000);
+            for (auto& maze : mazes)
+            {
+                maze.resize(sizes(random));
+                for (auto ii = size_t(0); ii < maze.size(); ii++)
+                {
+                    maze[ii] = std::uniform_int_distribution<int>(-static_cast<int>(ii), 2)(random);
+                }
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            std::vector<uint64_t> expected;
+            for (auto& maze : mazes)
+            {
+                expected.push_back(uint64_t(state<Part2Update>(maze).Solve()));
+            }
+            auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            char message[128];
+            snprintf(message, sizeof(message), "state<>: %.3f s", seconds);
+            Logger::WriteMessage(message);
+
+            for (auto level = 0; level <= static_cast<int>(DetectSimdLevel()); level++)
+            {
+                start = std::chrono::steady_clock::now();
+                auto moves = SolveJumpMazes<StrangeJump>(mazes, static_cast<SimdLevel>(level));
+                seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                Assert::IsTrue(moves == expected);
+
+                snprintf(message, sizeof(message), "level %d: %.3f s", level, seconds);
+                Logger::WriteMessage(message);
+            }
+        }
+
         TEST_METHOD(Day5_2_Final)
         {
-            auto raw = ReadAllLines("C:\\Day5.txt");
-            auto input = ConvertToInt(raw);
+            auto input = ConvertToInt(LineReader("C:\\Day5.txt"));
             Assert::AreEqual(24568703, state<Part2Update>(input).Solve());
+            Assert::IsTrue(SolveStrangeJumps(input) == 24568703);
         }
     };
 }
\ No newline at end of file
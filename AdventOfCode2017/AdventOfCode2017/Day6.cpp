@@ -1,8 +1,12 @@
 #include "stdafx.h"
 #include "CppUnitTest.h"
+#include "MemoryBanks.h"
 #include <vector>
 #include <algorithm>
 #include <map>
+#include <random>
+#include <chrono>
+#include <cstdio>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -32,6 +36,13 @@ namespace AdventOfCode2017
         }
 
         static std::pair<int, int> FindLoop(std::vector<int>& input)
+        {
+            auto loop = FindReallocationLoop(input);
+            return std::make_pair(static_cast<int>(loop.first), static_cast<int>(loop.second));
+        }
+
+        // Every configuration in a map, as a reference for FindLoop.
+        static std::pair<int, int> FindLoopByMap(std::vector<int>& input)
         {
             auto iteration = 0;
             std::map<std::vector<int>, int> pastStates;
@@ -111,6 +122,221 @@ namespace AdventOfCode2017
             Assert::AreEqual(4, FindLoopLength(input));
         }
 
+        TEST_METHOD(Day6_2_Test2)
+        {
+            // Bank sets whose keys pack into 64 bits, into 128 bits, and
+            // into neither (or not at all, with negative banks), so each
+            // key is tried, against the map.
+            std::mt19937 random(6);
+            const int shapes[][3] = { { 4, 0, 12 }, { 10, 0, 40 }, { 16, 0, 15 }, { 24, 0, 100 }, { 7, -5, 20 }, { 1, 0, 5 } };
+
+            for (auto& shape : shapes)
+            {
+                std::uniform_int_distribution<int> values(shape[1], shape[2]);
+                for (auto trial = 0; trial < 20; trial++)
+                {
+                    std::vector<int> input(shape[0]);
+                    for (auto& value : input)
+                    {
+                        value = values(random);
+                    }
+
+                    auto copy = input;
+                    auto expected = FindLoopByMap(copy);
+                    for (auto search : { LoopSearch::Brent, LoopSearch::Hashed })
+                    {
+                        auto loop = FindReallocationLoop(input, search);
+                        Assert::AreEqual(size_t(expected.first), loop.first);
+                        Assert::AreEqual(size_t(expected.second), loop.second);
+                    }
+                }
+            }
+
+            std::vector<int> empty;
+            Assert::IsTrue(FindReallocationLoop(empty, LoopSearch::Brent) == std::make_pair(size_t(1), size_t(1)));
+            Assert::IsTrue(FindReallocationLoop(empty, LoopSearch::Hashed) == std::make_pair(size_t(1), size_t(1)));
+
+            std::vector<int> final = { 2, 8, 8, 5, 4, 2, 3, 1, 5, 5, 1, 2, 15, 13, 5, 14, };
+            Assert::IsTrue(FindReallocationLoop(final, LoopSearch::Brent) == std::make_pair(size_t(3156), size_t(1610)));
+        }
+
+        TEST_METHOD(Day6_2_Test3)
+        {
+            // Runs of reallocations against ReAlloc, including counts that
+            // leave a SIMD tail, fewer blocks than banks, many more blocks
+            // than banks, and negative banks.
+            std::mt19937 random(24);
+            const int shapes[][3] = { { 1, 0, 9 }, { 3, 0, 2 }, { 5, 0, 50 }, { 13, -20, 20 }, { 16, 0, 3 }, { 37, 0, 500 }, { 64, -3, 64 } };
+
+            for (auto level = 0; level <= static_cast<int>(DetectSimdLevel()); level++)
+            {
+                for (auto& shape : shapes)
+                {
+                    std::uniform_int_distribution<int> values(shape[1], shape[2]);
+                    for (auto trial = 0; trial < 10; trial++)
+                    {
+                        std::vector<int> expected(shape[0]);
+                        for (auto& value : expected)
+                        {
+                            value = values(random);
+                        }
+
+                        auto actual = expected;
+                        auto fullest = static_cast<size_t>(FindMax(actual));
+                        for (auto step = 0; step < 50; step++)
+                        {
+                            ReAlloc(expected);
+                            fullest = Redistribute(actual.data(), actual.size(), fullest, static_cast<SimdLevel>(level));
+                            Assert::IsTrue(expected == actual);
+                            Assert::AreEqual(FindMax(expected), static_cast<int>(fullest));
+                        }
+                    }
+                }
+            }
+        }
+
+        TEST_METHOD(Day6_2_Test4)
+        {
+            // Ten thousand banks holding up to a hundred thousand blocks each,
+            // dealt one at a time and all at once.
+            std::mt19937 random(6);
+            std::uniform_int_distribution<int> values(0, 100000);
+            std::vector<int> start(10000);
+            for (auto& value : start)
+            {
+                value = values(random);
+            }
+
+            const auto Steps = 200;
+            auto expected = start;
+            auto begin = std::chrono::steady_clock::now();
+            for (auto step = 0; step < Steps; step++)
+            {
+                ReAlloc(expected);
+            }
+            auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+            char message[100];
+            snprintf(message, sizeof(message), "ReAlloc: %.3f s", seconds);
+            Logger::WriteMessage(message);
+
+            for (auto level = 0; level <= static_cast<int>(DetectSimdLevel()); level++)
+            {
+                auto actual = start;
+                auto fullest = static_cast<size_t>(FindMax(actual));
+                begin = std::chrono::steady_clock::now();
+                for (auto step = 0; step < Steps; step++)
+                {
+                    fullest = Redistribute(actual.data(), actual.size(), fullest, static_cast<SimdLevel>(level));
+                }
+                seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+                Assert::IsTrue(expected == actual);
+
+                snprintf(message, sizeof(message), "level %d: %.6f s", level, seconds);
+                Logger::WriteMessage(message);
+            }
+        }
+
+        TEST_METHOD(Day6_2_Test5)
+        {
+            // A batch mixing every key, against the map, in order, on one
+            // thread and on several.
+            std::mt19937 random(25);
+            const int shapes[][3] = { { 4, 0, 12 }, { 16, 0, 15 }, { 24, 0, 100 }, { 7, -5, 20 }, { 0, 0, 0 } };
+
+            std::vector<std::vector<int>> configurations;
+            for (auto trial = 0; trial < 30; trial++)
+            {
+                for (auto& shape : shapes)
+                {
+                    std::uniform_int_distribution<int> values(shape[1], shape[2]);
+                    std::vector<int> input(shape[0]);
+                    for (auto& value : input)
+                    {
+                        value = values(random);
+                    }
+                    configurations.push_back(input);
+                }
+            }
+
+            // The map cannot reallocate zero banks; an empty configuration
+            // repeats at once.
+            std::vector<std::pair<size_t, size_t>> expected;
+            for (auto input : configurations)
+            {
+                auto loop = input.empty() ? std::make_pair(1, 1) : FindLoopByMap(input);
+                expected.emplace_back(size_t(loop.first), size_t(loop.second));
+            }
+
+            for (auto threads : { size_t(1), size_t(4) })
+            {
+                ThreadPool pool(threads);
+                for (auto search : { LoopSearch::Brent, LoopSearch::Hashed })
+                {
+                    Assert::IsTrue(FindReallocationLoops(configurations, pool, search) == expected);
+                }
+                Assert::IsTrue(FindReallocationLoops({}, pool).empty());
+            }
+        }
+
+        TEST_METHOD(Day6_2_Test6)
+        {
+            // Four hundred layouts like the puzzle input as batches on pools
+            // of growing size, the first hundred also one map at a time to
+            // check against and to time. Kept small enough for the default
+            // run; raise the counts for a longer measurement.
+            std::mt19937 random(6);
+            std::uniform_int_distribution<int> values(0, 15);
+            std::vector<std::vector<int>> configurations(400, std::vector<int>(16));
+            for (auto& input : configurations)
+            {
+                for (auto& value : input)
+                {
+                    value = values(random);
+                }
+            }
+
+            const size_t checked = 100;
+            auto start = std::chrono::steady_clock::now();
+            std::vector<std::pair<size_t, size_t>> expected;
+            for (auto ii = size_t(0); ii < checked; ii++)
+            {
+                auto input = configurations[ii];
+                auto loop = FindLoopByMap(input);
+                expected.emplace_back(size_t(loop.first), size_t(loop.second));
+            }
+            auto single = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            char message[100];
+            snprintf(message, sizeof(message), "map: %.3f s for %zu", single, checked);
+            Logger::WriteMessage(message);
+
+            std::vector<size_t> threadCounts = { 1, 2, 4, ThreadPool::DefaultThreadCount() };
+            std::sort(threadCounts.begin(), threadCounts.end());
+            threadCounts.erase(std::unique(threadCounts.begin(), threadCounts.end()), threadCounts.end());
+
+            auto oneThread = 0.0;
+            std::vector<std::pair<size_t, size_t>> first;
+            for (auto threads : threadCounts)
+            {
+                ThreadPool pool(threads);
+                start = std::chrono::steady_clock::now();
+                auto loops = FindReallocationLoops(configurations, pool);
+                auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                Assert::IsTrue(std::equal(expected.begin(), expected.end(), loops.begin()));
+
+                if (threads == 1)
+                {
+                    oneThread = seconds;
+                    first = loops;
+                }
+                Assert::IsTrue(loops == first);
+
+                snprintf(message, sizeof(message), "%zu threads: %.3f s, %.2fx one thread", threads, seconds, oneThread / seconds);
+                Logger::WriteMessage(message);
+            }
+        }
+
         TEST_METHOD(Day6_2_Final)
         {
             std::vector<int> input = { 2, 8, 8, 5, 4, 2, 3, 1, 5, 5, 1, 2, 15, 13, 5, 14, };
@@ -1,10 +1,12 @@
 #include "stdafx.h"
 #include "CppUnitTest.h"
 #include "Utilities.h"
+#include "Parallel.h"
+#include "ParseCache.h"
+#include "ParseInt.h"
 #include <vector>
 #include <algorithm>
 #include <map>
-#include <sstream>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using namespace std;
@@ -26,32 +28,32 @@ namespace AdventOfCode2017
             vector<string> children;
         };
 
-        static program ParseProgram(const string& input)
+        static program ParseProgram(string_view input)
         {
-            auto stream = istringstream(input);
             auto p = program();
 
-            stream >> skipws >> p.name;
-            stream.ignore(numeric_limits<int>::max(), '(');
-            stream >> p.weight;
-            stream.ignore(numeric_limits<int>::max(), ')');
+            p.name = string(NextToken(input, " \t("));
 
-            while (!stream.eof())
+            auto open = input.find('(');
+            if (open == string_view::npos)
             {
-                string child;
-                stream >> child;
+                throw 1;
+            }
 
-                if (child.empty() || child == "->"s)
-                {
-                    continue;
-                }
+            input.remove_prefix(open + 1);
+            if (ConsumeInt32(input, p.weight) != ParseError::None || input.empty() || input.front() != ')')
+            {
+                throw 1;
+            }
+
+            input.remove_prefix(1);
 
-                if (child[child.size() - 1] == ',')
+            for (auto child = NextToken(input, " \t,"); !child.empty(); child = NextToken(input, " \t,"))
+            {
+                if (child != "->")
                 {
-                    child.pop_back();
+                    p.children.emplace_back(child);
                 }
-
-                p.children.push_back(child);
             }
 
             return p;
@@ -158,6 +160,72 @@ namespace AdventOfCode2017
             return make_pair(root, rootNode.weight + difference);
         }
 
+        static void SaveTower(BinaryWriter& writer, const map<string, program>& tower)
+        {
+            writer.Write(static_cast<uint64_t>(tower.size()));
+
+            for (auto iter = tower.begin(); iter != tower.end(); iter++)
+            {
+                const program& p = iter->second;
+                writer.WriteString(p.name);
+                writer.WriteString(p.parent);
+                writer.Write(p.weight);
+                writer.Write(static_cast<uint32_t>(p.children.size()));
+
+                for (auto child = p.children.begin(); child != p.children.end(); child++)
+                {
+                    writer.WriteString(*child);
+                }
+            }
+        }
+
+        static map<string, program> LoadTower(BinaryReader& reader)
+        {
+            auto tower = map<string, program>();
+            auto count = reader.Read<uint64_t>();
+
+            for (auto ii = uint64_t(0); ii < count; ii++)
+            {
+                auto p = program(string(reader.ReadString()));
+                p.parent = reader.ReadString();
+                p.weight = reader.Read<int>();
+
+                auto childCount = reader.Read<uint32_t>();
+                for (auto child = uint32_t(0); child < childCount; child++)
+                {
+                    p.children.emplace_back(reader.ReadString());
+                }
+
+                tower.emplace_hint(tower.end(), p.name, move(p));
+            }
+
+            return tower;
+        }
+
+        static map<string, program> ReadTower(const string& fileName)
+        {
+            auto input = MappedInput(fileName);
+            auto contents = input.Contents();
+
+            return CachedParse(
+                HashContents(contents),
+                fileName + ".cache"s,
+                1,
+                [contents]()
+                {
+                    auto elements = map<string, program>();
+                    auto programs = ParallelParseLines(contents, ParseProgram);
+                    for (auto iter = programs.begin(); iter != programs.end(); iter++)
+                    {
+                        UpdateMap(*iter, elements);
+                    }
+
+                    return elements;
+                },
+                SaveTower,
+                LoadTower);
+        }
+
     public:
         TEST_METHOD(Day7_1_Test1)
         {
@@ -290,10 +358,11 @@ namespace AdventOfCode2017
         {
             auto elements = map<string, program>();
 
-            auto lines = ReadAllLines("C:\\Day7.txt"s);
-            for (auto iter = lines.begin(); iter != lines.end(); iter++)
+            auto input = MappedInput("C:\\Day7.txt"s);
+            auto programs = ParallelParseLines(input.Contents(), ParseProgram);
+            for (auto iter = programs.begin(); iter != programs.end(); iter++)
             {
-                UpdateMap(ParseProgram(*iter), elements);
+                UpdateMap(*iter, elements);
             }
 
             Assert::AreEqual("cqmvs"s, FindRoot(elements));
@@ -366,15 +435,47 @@ namespace AdventOfCode2017
             Assert::AreEqual(60, imbalance.second);
         }
 
-        TEST_METHOD(Day7_2_Final)
+        TEST_METHOD(Day7_2_Test4)
         {
             auto elements = map<string, program>();
 
-            auto lines = ReadAllLines("C:\\Day7.txt"s);
-            for (auto iter = lines.begin(); iter != lines.end(); iter++)
+            UpdateMap(ParseProgram("pbga (66)"s), elements);
+            UpdateMap(ParseProgram("fwft (72) -> ktlj, cntj, xhth"s), elements);
+            UpdateMap(ParseProgram("padx (45) -> pbga, havc, qoyq"s), elements);
+
+            BinaryWriter writer;
+            SaveTower(writer, elements);
+            BinaryReader reader(writer.Buffer());
+            auto loaded = LoadTower(reader);
+
+            Assert::IsTrue(reader.AtEnd());
+            Assert::AreEqual(elements.size(), loaded.size());
+            for (auto iter = elements.begin(); iter != elements.end(); iter++)
+            {
+                const program& expected = iter->second;
+                const program& actual = loaded[iter->first];
+                Assert::AreEqual(expected.name, actual.name);
+                Assert::AreEqual(expected.parent, actual.parent);
+                Assert::IsTrue(expected.children == actual.children);
+            }
+            Assert::AreEqual(72, loaded["fwft"s].weight);
+
+            BinaryReader truncated(string_view(writer.Buffer()).substr(0, writer.Buffer().size() - 1));
+            auto threw = false;
+            try
             {
-                UpdateMap(ParseProgram(*iter), elements);
+                LoadTower(truncated);
             }
+            catch (int)
+            {
+                threw = true;
+            }
+            Assert::IsTrue(threw);
+        }
+
+        TEST_METHOD(Day7_2_Final)
+        {
+            auto elements = ReadTower("C:\\Day7.txt"s);
 
             auto imbalance = Balance(elements);
             Assert::AreEqual("vmttcwe"s, imbalance.first);
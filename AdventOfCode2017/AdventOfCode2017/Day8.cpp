@@ -1,10 +1,11 @@
 #include "stdafx.h"
 #include "CppUnitTest.h"
 #include "Utilities.h"
+#include "ParseInt.h"
+#include "ReadAhead.h"
 #include <vector>
 #include <algorithm>
 #include <map>
-#include <sstream>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using namespace std;
@@ -103,18 +104,26 @@ namespace AdventOfCode2017::Day8
     TEST_CLASS(Day8)
     {
     private:
-        static program ParseProgram(const string& input)
+        static program ParseProgram(string_view input)
         {
-            auto stream = istringstream(input);
             auto p = program();
-            string op;
-            string dummy;
-            string comp;
 
-            stream >> skipws >> p.reg >> op >> p.amount >> dummy >> p.guard.reg >> comp >> p.guard.value;
+            p.reg = string(NextToken(input));
+            auto op = NextToken(input);
+            auto amount = NextToken(input);
+            NextToken(input);
+            p.guard.reg = string(NextToken(input));
+            auto comp = NextToken(input);
+            auto value = NextToken(input);
 
-            p.op = Operations[op];
-            p.guard.comp = Comparisons[comp];
+            if (ParseInt32(amount, p.amount).error != ParseError::None ||
+                ParseInt32(value, p.guard.value).error != ParseError::None)
+            {
+                throw 1;
+            }
+
+            p.op = Operations[string(op)];
+            p.guard.comp = Comparisons[string(comp)];
 
             return p;
         }
@@ -166,10 +175,10 @@ namespace AdventOfCode2017::Day8
         {
             auto regs = map<string, int>();
 
-            auto lines = ReadAllLines("C:\\Day8.txt"s);
+            AsyncLineReader lines("C:\\Day8.txt"s);
 
             auto maxEver = 0;
-            for (auto iter = lines.begin(); iter != lines.end(); iter++)
+            for (auto iter = lines.begin(); iter != lines.end(); ++iter)
             {
                 maxEver = max(maxEver, ParseProgram(*iter).Evaluate(regs));
             }
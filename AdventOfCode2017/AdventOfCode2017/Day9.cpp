@@ -3,6 +3,8 @@
 #include "Utilities.h"
 #include <stack>
 #include <memory>
+#include <algorithm>
+#include <cctype>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using namespace std;
@@ -0,0 +1,378 @@
+#include "stdafx.h"
+#include "DivisiblePairs.h"
+#include <algorithm>
+#include <intrin.h>
+
+namespace AdventOfCode2017
+{
+    namespace
+    {
+        const uint32_t NoIndex = static_cast<uint32_t>(-1);
+
+        // A bitset costs one bit per possible value; past this many bits per
+        // row entry the hash table is smaller.
+        const int64_t DenseBitsPerEntry = 64;
+        const int64_t MinimumDenseBits = 64 * 1024;
+
+        // Fibonacci hashing: the top bits of value times 2^32 / phi.
+        uint32_t SlotOf(int32_t value, uint32_t shift)
+        {
+            return (static_cast<uint32_t>(value) * 2654435769u) >> shift;
+        }
+
+        // The pair a pairwise scan reaches first has the lowest first index
+        // and then the lowest second index. For two different values that is
+        // always their first occurrences; for a repeated value, its first two.
+        struct bestPair
+        {
+            uint32_t first = NoIndex;
+            uint32_t second = NoIndex;
+            int quotient = 0;
+
+            void Consider(uint32_t a, uint32_t b, int pairQuotient)
+            {
+                auto low = std::min(a, b);
+                auto high = std::max(a, b);
+
+                if (low < first || (low == first && high < second))
+                {
+                    first = low;
+                    second = high;
+                    quotient = pairQuotient;
+                }
+            }
+        };
+
+        // n is a multiple of d exactly when rotr(n * inverse, shift) <= limit,
+        // where d = odd << shift and inverse is odd's inverse mod 2^32
+        // (Granlund and Montgomery). This holds for every 32-bit unsigned n.
+        struct divisibilityTest
+        {
+            uint32_t inverse;
+            uint32_t shift;
+            uint32_t limit;
+        };
+
+        divisibilityTest MakeDivisibilityTest(uint32_t divisor)
+        {
+            unsigned long shift;
+            _BitScanForward(&shift, divisor);
+            auto odd = divisor >> shift;
+
+            // odd is its own inverse mod 8, and each Newton step doubles the
+            // number of correct low bits: 3, 6, 12, 24, 48.
+            auto inverse = odd;
+            for (auto ii = 0; ii < 4; ii++)
+            {
+                inverse *= 2 - odd * inverse;
+            }
+
+            return divisibilityTest{ inverse, static_cast<uint32_t>(shift), 0xFFFFFFFFu / divisor };
+        }
+
+        bool IsDivisible(uint32_t number, const divisibilityTest& test)
+        {
+            auto product = number * test.inverse;
+            auto rotated = test.shift == 0 ? product : (product >> test.shift) | (product << (32 - test.shift));
+            return rotated <= test.limit;
+        }
+
+        // Per-lane IsDivisible; shifts of 32 shift everything out, which
+        // makes a zero shift rotate correctly.
+        __m256i DivisibleMask(__m256i numbers, __m256i inverse, __m256i shift, __m256i limit)
+        {
+            auto product = _mm256_mullo_epi32(numbers, inverse);
+            auto rotated = _mm256_or_si256(
+                _mm256_srlv_epi32(product, shift),
+                _mm256_sllv_epi32(product, _mm256_sub_epi32(_mm256_set1_epi32(32), shift)));
+
+            return _mm256_cmpeq_epi32(_mm256_min_epu32(rotated, limit), rotated);
+        }
+
+        unsigned LowestLane(int mask)
+        {
+            unsigned long lane;
+            _BitScanForward(&lane, static_cast<unsigned long>(mask));
+            return lane;
+        }
+
+        int PairQuotient(int32_t a, int32_t b)
+        {
+            auto sorted = std::minmax(a, b);
+            return sorted.second / sorted.first;
+        }
+    }
+
+    int PairwiseDivisibleQuotient(const int32_t* row, size_t count)
+    {
+        for (auto ii = size_t(0); ii < count; ii++)
+        {
+            for (auto jj = ii + 1; jj < count; jj++)
+            {
+                auto sorted = std::minmax(row[ii], row[jj]);
+                if (sorted.second % sorted.first == 0)
+                {
+                    return sorted.second / sorted.first;
+                }
+            }
+        }
+
+        return 0;
+    }
+
+    int DivisionFreeQuotient(const int32_t* row, size_t count, SimdLevel level)
+    {
+        if (count < 2)
+        {
+            return 0;
+        }
+
+        if (*std::min_element(row, row + count) <= 0)
+        {
+            return PairwiseDivisibleQuotient(row, count);
+        }
+
+        // Tests stored as separate arrays so eight of them load at once.
+        auto numbers = reinterpret_cast<const uint32_t*>(row);
+        std::vector<uint32_t> inverses(count);
+        std::vector<uint32_t> shifts(count);
+        std::vector<uint32_t> limits(count);
+
+        for (auto ii = size_t(0); ii < count; ii++)
+        {
+            auto test = MakeDivisibilityTest(numbers[ii]);
+            inverses[ii] = test.inverse;
+            shifts[ii] = test.shift;
+            limits[ii] = test.limit;
+        }
+
+        for (auto ii = size_t(0); ii < count; ii++)
+        {
+            auto test = divisibilityTest{ inverses[ii], shifts[ii], limits[ii] };
+            auto jj = ii + 1;
+
+            if (level == SimdLevel::Avx2)
+            {
+                auto number = _mm256_set1_epi32(row[ii]);
+                auto inverse = _mm256_set1_epi32(test.inverse);
+                auto shift = _mm256_set1_epi32(test.shift);
+                auto limit = _mm256_set1_epi32(test.limit);
+
+                for (; jj + 8 <= count; jj += 8)
+                {
+                    // Either partner can be the divisor: row[jj] a multiple of
+                    // row[ii], or row[ii] a multiple of row[jj].
+                    auto others = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(numbers + jj));
+                    auto multiples = DivisibleMask(others, inverse, shift, limit);
+                    auto divisors = DivisibleMask(
+                        number,
+                        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(inverses.data() + jj)),
+                        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(shifts.data() + jj)),
+                        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(limits.data() + jj)));
+
+                    auto mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_or_si256(multiples, divisors)));
+                    if (mask != 0)
+                    {
+                        return PairQuotient(row[ii], row[jj + LowestLane(mask)]);
+                    }
+                }
+            }
+
+            for (; jj < count; jj++)
+            {
+                if (IsDivisible(numbers[jj], test) ||
+                    IsDivisible(numbers[ii], divisibilityTest{ inverses[jj], shifts[jj], limits[jj] }))
+                {
+                    return PairQuotient(row[ii], row[jj]);
+                }
+            }
+        }
+
+        return 0;
+    }
+
+    int DivisibleQuotient(const int32_t* row, size_t count)
+    {
+        return DivisiblePairFinder().Quotient(row, count);
+    }
+
+    void DivisiblePairFinder::SortDistinct(const int32_t* row, size_t count)
+    {
+        sorted.resize(count);
+        for (auto ii = size_t(0); ii < count; ii++)
+        {
+            sorted[ii] = std::make_pair(row[ii], static_cast<uint32_t>(ii));
+        }
+
+        std::sort(sorted.begin(), sorted.end());
+
+        values.clear();
+        plainValues.clear();
+        for (auto& entry : sorted)
+        {
+            if (!values.empty() && values.back().value == entry.first)
+            {
+                if (values.back().second == NoIndex)
+                {
+                    values.back().second = entry.second;
+                }
+            }
+            else
+            {
+                values.push_back(distinctValue{ entry.first, entry.second, NoIndex });
+                plainValues.push_back(static_cast<uint32_t>(entry.first));
+            }
+        }
+    }
+
+    void DivisiblePairFinder::IndexValues()
+    {
+        auto maximum = static_cast<int64_t>(values.back().value);
+
+        bits.clear();
+        slots.clear();
+
+        if (maximum < std::max(MinimumDenseBits, DenseBitsPerEntry * static_cast<int64_t>(values.size())))
+        {
+            bits.resize(static_cast<size_t>(maximum / 64 + 1));
+            for (auto& entry : values)
+            {
+                bits[entry.value / 64] |= uint64_t(1) << (entry.value % 64);
+            }
+        }
+        else
+        {
+            // At most half full, so probe runs stay short.
+            slotShift = 31;
+            while ((size_t(1) << (32 - slotShift)) < values.size() * 2)
+            {
+                slotShift--;
+            }
+
+            auto mask = (uint32_t(1) << (32 - slotShift)) - 1;
+            slots.assign(size_t(mask) + 1, indexSlot{ 0, 0 });
+
+            for (auto ii = size_t(0); ii < values.size(); ii++)
+            {
+                auto slot = SlotOf(values[ii].value, slotShift);
+                while (slots[slot].value != 0)
+                {
+                    slot = (slot + 1) & mask;
+                }
+
+                slots[slot] = indexSlot{ values[ii].value, static_cast<uint32_t>(ii) };
+            }
+        }
+    }
+
+    const DivisiblePairFinder::distinctValue* DivisiblePairFinder::Find(int64_t value) const
+    {
+        if (!bits.empty())
+        {
+            if ((bits[static_cast<size_t>(value / 64)] & (uint64_t(1) << (value % 64))) == 0)
+            {
+                return nullptr;
+            }
+
+            auto found = std::lower_bound(values.begin(), values.end(), value,
+                [](const distinctValue& entry, int64_t target) { return entry.value < target; });
+            return &*found;
+        }
+
+        auto mask = static_cast<uint32_t>(slots.size() - 1);
+        for (auto slot = SlotOf(static_cast<int32_t>(value), slotShift); slots[slot].value != 0; slot = (slot + 1) & mask)
+        {
+            if (slots[slot].value == value)
+            {
+                return &values[slots[slot].index];
+            }
+        }
+
+        return nullptr;
+    }
+
+    int DivisiblePairFinder::Quotient(const int32_t* row, size_t count)
+    {
+        if (count < 2)
+        {
+            return 0;
+        }
+
+        SortDistinct(row, count);
+
+        if (values.front().value <= 0)
+        {
+            return PairwiseDivisibleQuotient(row, count);
+        }
+
+        bestPair best;
+
+        for (auto& entry : values)
+        {
+            if (entry.second != NoIndex)
+            {
+                best.Consider(entry.first, entry.second, 1);
+            }
+        }
+
+        IndexValues();
+        auto maximum = static_cast<int64_t>(values.back().value);
+        auto level = DetectSimdLevel();
+
+        // Walking multiples of a costs maximum / a probes and checking the
+        // larger values costs one multiply-and-compare each; summed over the
+        // row, the walks are bounded by the harmonic series.
+        for (auto ii = size_t(0); ii + 1 < values.size(); ii++)
+        {
+            auto divisor = values[ii].value;
+            auto multiples = maximum / divisor - 1;
+            auto larger = static_cast<int64_t>(values.size() - ii - 1);
+
+            if (multiples <= larger)
+            {
+                for (auto multiple = int64_t(divisor) * 2; multiple <= maximum; multiple += divisor)
+                {
+                    auto found = Find(multiple);
+                    if (found != nullptr)
+                    {
+                        best.Consider(values[ii].first, found->first, static_cast<int>(multiple / divisor));
+                    }
+                }
+            }
+            else
+            {
+                auto test = MakeDivisibilityTest(divisor);
+                auto jj = ii + 1;
+
+                if (level == SimdLevel::Avx2)
+                {
+                    auto inverse = _mm256_set1_epi32(test.inverse);
+                    auto shift = _mm256_set1_epi32(test.shift);
+                    auto limit = _mm256_set1_epi32(test.limit);
+
+                    for (; jj + 8 <= values.size(); jj += 8)
+                    {
+                        auto others = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(plainValues.data() + jj));
+                        auto mask = _mm256_movemask_ps(_mm256_castsi256_ps(DivisibleMask(others, inverse, shift, limit)));
+
+                        for (; mask != 0; mask &= mask - 1)
+                        {
+                            auto& multiple = values[jj + LowestLane(mask)];
+                            best.Consider(values[ii].first, multiple.first, multiple.value / divisor);
+                        }
+                    }
+                }
+
+                for (; jj < values.size(); jj++)
+                {
+                    if (IsDivisible(plainValues[jj], test))
+                    {
+                        best.Consider(values[ii].first, values[jj].first, values[jj].value / divisor);
+                    }
+                }
+            }
+        }
+
+        return best.quotient;
+    }
+}
\ No newline at end of file
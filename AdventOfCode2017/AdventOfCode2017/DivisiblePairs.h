@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Simd.h"
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+namespace AdventOfCode2017
+{
+    // Day 2 part 2 for one row: the quotient of the first pair of entries
+    // (in row order, as a pairwise scan would meet them) where one evenly
+    // divides the other, or 0 when there is none.
+    //
+    // Positive rows are handled without the quadratic scan: distinct values
+    // are sorted, and each one either walks its multiples up to the row
+    // maximum through a presence bitset (a hash table when the values are
+    // too sparse for a bitset) or tests the larger values directly with the
+    // DivisionFreeQuotient test, whichever is fewer candidates. Rows with
+    // zero or negative entries use the pairwise scan.
+    int DivisibleQuotient(const int32_t* row, size_t count);
+
+    // DivisibleQuotient with its working buffers, the hash table included,
+    // kept between calls, so scoring many rows only allocates when a row
+    // outgrows all before it.
+    class DivisiblePairFinder
+    {
+    public:
+        int Quotient(const int32_t* row, size_t count);
+
+    private:
+        struct distinctValue
+        {
+            int32_t value;
+            uint32_t first;
+            uint32_t second;
+        };
+
+        // An open-addressing slot: a positive value and its index in values,
+        // or value 0 when empty.
+        struct indexSlot
+        {
+            int32_t value;
+            uint32_t index;
+        };
+
+        void SortDistinct(const int32_t* row, size_t count);
+        void IndexValues();
+        const distinctValue* Find(int64_t value) const;
+
+        std::vector<std::pair<int32_t, uint32_t>> sorted;
+        std::vector<distinctValue> values;
+
+        // values[i].value laid out contiguously for the vector scans.
+        std::vector<uint32_t> plainValues;
+        std::vector<uint64_t> bits;
+
+        // Power-of-two table for rows too sparse for the bitset; refilled
+        // for each such row without giving back its storage.
+        std::vector<indexSlot> slots;
+        uint32_t slotShift = 32;
+    };
+
+    // The plain O(count^2) scan DivisibleQuotient must agree with.
+    int PairwiseDivisibleQuotient(const int32_t* row, size_t count);
+
+    // The same pairwise scan without hardware division in the loop: each
+    // entry gets a precomputed multiply-and-compare divisibility test, and
+    // with AVX2 eight partners are tested at once. Only the quotient of the
+    // pair that is found is computed with a divide. Rows with zero or
+    // negative entries use PairwiseDivisibleQuotient.
+    int DivisionFreeQuotient(const int32_t* row, size_t count, SimdLevel level = DetectSimdLevel());
+}
\ No newline at end of file
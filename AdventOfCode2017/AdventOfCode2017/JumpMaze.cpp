@@ -0,0 +1,258 @@
+#include "stdafx.h"
+#include "JumpMaze.h"
+#include <algorithm>
+#include <limits>
+
+namespace AdventOfCode2017
+{
+    namespace
+    {
+        // Settled cells are one bit each, set for an offset of 3 and clear
+        // for 2, sixteen to a block.
+        const size_t BlockCells = 16;
+
+        // For each block of settled cells, the cells visited when it is
+        // entered at cell 0, 1 or 2, which is everywhere a jump from the
+        // block before can land, and the cell each of those enters the next
+        // block at. Exits are kept as four times the cell, four bits apiece,
+        // so that the next entry is a shift and a mask of the last and the
+        // table lookups themselves never wait on it.
+        struct blockMoves
+        {
+            uint16_t visited[3];
+            uint16_t exits;
+        };
+
+        const std::vector<blockMoves>& MoveTable()
+        {
+            static const std::vector<blockMoves> table = []()
+            {
+                std::vector<blockMoves> result(size_t(1) << BlockCells);
+                for (auto bits = 0u; bits < result.size(); bits++)
+                {
+                    auto& moves = result[bits];
+                    moves.exits = 0;
+                    for (auto entry = 0u; entry < 3; entry++)
+                    {
+                        auto visited = 0u;
+                        auto position = entry;
+                        while (position < BlockCells)
+                        {
+                            visited |= 1u << position;
+                            position += 2 + ((bits >> position) & 1);
+                        }
+
+                        moves.visited[entry] = static_cast<uint16_t>(visited);
+                        moves.exits |= static_cast<uint16_t>(4 * (position - BlockCells) << (4 * entry));
+                    }
+                }
+                return result;
+            }();
+
+            return table;
+        }
+
+        // The same for half a block entered at any cell, so that the block
+        // a sweep starts in is not walked either. Entering past the half
+        // visits nothing and leaves that much further on.
+        struct halfMoves
+        {
+            uint8_t visited[BlockCells];
+            uint8_t exits[BlockCells];
+        };
+
+        const std::vector<halfMoves>& HalfTable()
+        {
+            static const std::vector<halfMoves> table = []()
+            {
+                const auto halfCells = BlockCells / 2;
+                std::vector<halfMoves> result(size_t(1) << halfCells);
+                for (auto bits = 0u; bits < result.size(); bits++)
+                {
+                    for (auto entry = 0u; entry < BlockCells; entry++)
+                    {
+                        auto visited = 0u;
+                        auto position = entry;
+                        while (position < halfCells)
+                        {
+                            visited |= 1u << position;
+                            position += 2 + ((bits >> position) & 1);
+                        }
+
+                        result[bits].visited[entry] = static_cast<uint8_t>(visited);
+                        result[bits].exits[entry] = static_cast<uint8_t>(position - halfCells);
+                    }
+                }
+                return result;
+            }();
+
+            return table;
+        }
+
+        unsigned CountThrees(uint16_t bits)
+        {
+            auto count = 0u;
+            for (; bits != 0; bits &= bits - 1)
+            {
+                count++;
+            }
+            return count;
+        }
+
+        // Offsets start in [low, high] and move towards 3 without passing
+        // it, so they stay within [min(low, 2), max(high, 3)]. The lowest
+        // value of the type is kept back to mark settled cells.
+        template<class Cell>
+        bool Holds(int low, int high)
+        {
+            return std::min(low, 2) > std::numeric_limits<Cell>::min() && std::max(high, 3) <= std::numeric_limits<Cell>::max();
+        }
+
+        bool IsSettled(int offset)
+        {
+            return offset == 2 || offset == 3;
+        }
+
+        template<class Cell>
+        uint64_t Solve(std::vector<int>& jumps)
+        {
+            auto& table = MoveTable();
+            auto& halves = HalfTable();
+            auto size = jumps.size();
+            auto blockCount = (size + BlockCells - 1) / BlockCells;
+            std::vector<Cell> cells(jumps.begin(), jumps.end());
+
+            // Each block counts its cells that are not yet 2 or 3; once none
+            // are left its cells live in its bits, and are marked in cells so
+            // that a single step finds out from the offset it loads. A
+            // settled cell stays settled, so a count only goes down, and a
+            // block cut short by the end of the maze never settles.
+            const auto settledMark = std::numeric_limits<Cell>::min();
+            std::vector<uint16_t> bits(blockCount);
+            std::vector<uint8_t> unsettled(blockCount, static_cast<uint8_t>(BlockCells + 1));
+
+            // Jumps through settled blocks are not counted one by one. A
+            // jump from a 2 moves two cells and adds a 3, and a jump from a
+            // 3 moves three and takes one away, so every such jump is worth
+            // five in twice the distance covered plus the change in 3s.
+            auto unsettledSteps = uint64_t(0);
+            auto settledDistance = uint64_t(0);
+            auto settledThrees = uint64_t(0);
+
+            auto settle = [&](size_t block)
+            {
+                auto blockBits = 0u;
+                for (auto ii = size_t(0); ii < BlockCells; ii++)
+                {
+                    blockBits |= unsigned(cells[block * BlockCells + ii] - 2) << ii;
+                }
+
+                bits[block] = static_cast<uint16_t>(blockBits);
+                settledThrees += CountThrees(bits[block]);
+                std::fill(cells.begin() + block * BlockCells, cells.begin() + (block + 1) * BlockCells, settledMark);
+            };
+
+            for (auto block = size_t(0); block < size / BlockCells; block++)
+            {
+                unsettled[block] = static_cast<uint8_t>(std::count_if(
+                    cells.begin() + block * BlockCells,
+                    cells.begin() + (block + 1) * BlockCells,
+                    [](Cell cell) { return !IsSettled(cell); }));
+
+                if (unsettled[block] == 0)
+                {
+                    settle(block);
+                }
+            }
+
+            auto pc = size_t(0);
+            while (pc < size)
+            {
+                auto adjustment = int(cells[pc]);
+                if (adjustment == settledMark)
+                {
+                    auto block = pc / BlockCells;
+
+                    // The first block may be entered anywhere, and is taken
+                    // a half at a time; the ones after it are entered at
+                    // cell 0, 1 or 2.
+                    auto firstBits = unsigned(bits[block]);
+                    auto& low = halves[firstBits & 255];
+                    auto& high = halves[firstBits >> 8];
+                    auto start = pc % BlockCells;
+                    auto middle = low.exits[start];
+                    bits[block] = static_cast<uint16_t>(firstBits ^ (low.visited[start] | high.visited[middle] << 8));
+
+                    auto entry = 4u * high.exits[middle];
+                    auto moveTable = table.data();
+                    auto blockBits = bits.data();
+                    auto counts = unsettled.data();
+                    for (block++; block < blockCount && counts[block] == 0; block++)
+                    {
+                        auto& moves = moveTable[blockBits[block]];
+                        blockBits[block] ^= moves.visited[entry / 4];
+                        entry = (moves.exits >> entry) & 15;
+                    }
+
+                    auto exit = block * BlockCells + entry / 4;
+                    settledDistance += exit - pc;
+                    pc = exit;
+                    continue;
+                }
+
+                // Only a 1 or a 4 becomes a 2 or a 3.
+                auto current = pc;
+                cells[current] = static_cast<Cell>(adjustment >= 3 ? adjustment - 1 : adjustment + 1);
+                pc += adjustment;
+                unsettledSteps++;
+
+                if ((adjustment == 1 || adjustment == 4) && --unsettled[current / BlockCells] == 0)
+                {
+                    settle(current / BlockCells);
+                }
+            }
+
+            auto finalThrees = uint64_t(0);
+            for (auto ii = size_t(0); ii < size; ii++)
+            {
+                auto block = ii / BlockCells;
+                if (unsettled[block] == 0)
+                {
+                    auto three = (bits[block] >> (ii % BlockCells)) & 1;
+                    finalThrees += three;
+                    jumps[ii] = 2 + three;
+                }
+                else
+                {
+                    jumps[ii] = cells[ii];
+                }
+            }
+
+            return unsettledSteps + (2 * settledDistance + finalThrees - settledThrees) / 5;
+        }
+    }
+
+    uint64_t SolveStrangeJumps(std::vector<int>& jumps)
+    {
+        if (jumps.empty())
+        {
+            return 0;
+        }
+
+        auto range = std::minmax_element(jumps.begin(), jumps.end());
+        auto low = *range.first;
+        auto high = *range.second;
+
+        if (Holds<int8_t>(low, high))
+        {
+            return Solve<int8_t>(jumps);
+        }
+
+        if (Holds<int16_t>(low, high))
+        {
+            return Solve<int16_t>(jumps);
+        }
+
+        return Solve<int32_t>(jumps);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,454 @@
+#include "stdafx.h"
+#include "MemoryBanks.h"
+#include "Utilities.h"
+#include <algorithm>
+#include <limits>
+
+namespace AdventOfCode2017
+{
+    namespace
+    {
+        uint64_t HashKey(uint64_t key)
+        {
+            return Mix(key);
+        }
+
+        uint64_t HashKey(const UInt128& key)
+        {
+            return Mix(key.low ^ Mix(key.high));
+        }
+
+        // Keys of the configurations seen so far, each with the number of
+        // reallocations it was first seen after. At most half full, so
+        // probes stay short. Slots carry the stamp of the search that filled
+        // them, so clearing for the next search touches none of them.
+        template<class Key>
+        class seenTable
+        {
+        public:
+            // Finds a configuration seen earlier with this key, for which
+            // same(index) confirms it is the current one, and sets first to
+            // when it was seen. Otherwise records key as seen at index.
+            template<class Same>
+            bool FindOrAdd(const Key& key, uint64_t index, Same same, uint64_t& first)
+            {
+                if (2 * (count + 1) > slots.size())
+                {
+                    Grow();
+                }
+
+                auto mask = slots.size() - 1;
+                for (auto slot = HashKey(key) & mask; ; slot = (slot + 1) & mask)
+                {
+                    auto& entry = slots[slot];
+                    if (entry.stamp != stamp)
+                    {
+                        entry = seenEntry{ key, index, stamp };
+                        count++;
+                        return false;
+                    }
+
+                    if (entry.key == key && same(entry.index))
+                    {
+                        first = entry.index;
+                        return true;
+                    }
+                }
+            }
+
+            void Clear()
+            {
+                count = 0;
+                if (++stamp == 0)
+                {
+                    for (auto& entry : slots)
+                    {
+                        entry.stamp = 0;
+                    }
+                    stamp = 1;
+                }
+            }
+
+        private:
+            struct seenEntry
+            {
+                Key key;
+                uint64_t index;
+                uint32_t stamp;
+            };
+
+            void Grow()
+            {
+                std::vector<seenEntry> old(std::max(2 * slots.size(), size_t(64)), seenEntry{ Key(), 0, 0 });
+                old.swap(slots);
+
+                auto mask = slots.size() - 1;
+                for (auto& entry : old)
+                {
+                    if (entry.stamp == stamp)
+                    {
+                        auto slot = HashKey(entry.key) & mask;
+                        while (slots[slot].stamp == stamp)
+                        {
+                            slot = (slot + 1) & mask;
+                        }
+                        slots[slot] = entry;
+                    }
+                }
+            }
+
+            std::vector<seenEntry> slots;
+            size_t count = 0;
+            uint32_t stamp = 1;
+        };
+
+        // Banks with their fullest bank, which each reallocation finds for
+        // the one after it.
+        struct bankState
+        {
+            explicit bankState(const std::vector<int>& start)
+                : banks(start), fullest(std::max_element(start.begin(), start.end()) - start.begin())
+            {
+            }
+
+            void Step()
+            {
+                if (!banks.empty())
+                {
+                    fullest = Redistribute(banks.data(), banks.size(), fullest);
+                }
+            }
+
+            std::vector<int> banks;
+            size_t fullest;
+        };
+
+        template<class Key, class KeyOf>
+        std::pair<size_t, size_t> SearchHashed(const std::vector<int>& start, seenTable<Key>& seen, KeyOf keyOf, bool exact)
+        {
+            bankState current(start);
+
+            // A fingerprint match is only a candidate until the earlier
+            // configuration, rebuilt from the start, equals this one.
+            auto same = [&start, &current, exact](uint64_t index)
+            {
+                if (exact)
+                {
+                    return true;
+                }
+
+                bankState earlier(start);
+                for (auto ii = uint64_t(0); ii < index; ii++)
+                {
+                    earlier.Step();
+                }
+                return earlier.banks == current.banks;
+            };
+
+            seen.Clear();
+            for (auto index = uint64_t(0); ; index++)
+            {
+                uint64_t first;
+                if (seen.FindOrAdd(keyOf(current.banks), index, same, first))
+                {
+                    return std::make_pair(static_cast<size_t>(index), static_cast<size_t>(index - first));
+                }
+
+                current.Step();
+            }
+        }
+
+        std::pair<size_t, size_t> SearchBrent(const std::vector<int>& start)
+        {
+            // The loop length: the hare runs ahead in stretches of doubling
+            // length, and the tortoise waits at the start of each stretch
+            // until the hare comes round to it.
+            bankState tortoise(start);
+            bankState hare(start);
+            hare.Step();
+
+            auto power = size_t(1);
+            auto length = size_t(1);
+            while (tortoise.banks != hare.banks)
+            {
+                if (power == length)
+                {
+                    tortoise = hare;
+                    power *= 2;
+                    length = 0;
+                }
+
+                hare.Step();
+                length++;
+            }
+
+            // Then where the loop starts: with the hare a loop length ahead,
+            // the two first meet on its first configuration.
+            tortoise = bankState(start);
+            hare = bankState(start);
+            for (auto ii = size_t(0); ii < length; ii++)
+            {
+                hare.Step();
+            }
+
+            auto lead = size_t(0);
+            while (tortoise.banks != hare.banks)
+            {
+                tortoise.Step();
+                hare.Step();
+                lead++;
+            }
+
+            return std::make_pair(lead + length, length);
+        }
+    }
+
+    void Reallocate(std::vector<int>& banks)
+    {
+        if (!banks.empty())
+        {
+            Redistribute(banks.data(), banks.size(), std::max_element(banks.begin(), banks.end()) - banks.begin());
+        }
+    }
+
+    size_t Redistribute(int* banks, size_t count, size_t source, SimdLevel level)
+    {
+        auto blocks = std::max(banks[source], 0);
+        auto share = static_cast<int>(blocks / count);
+        auto rest = static_cast<size_t>(blocks) % count;
+        banks[source] = 0;
+
+        // The banks after source that get one more are [first, last), and
+        // [0, wrapped) when they run past the end.
+        auto first = static_cast<int>(source + 1);
+        auto last = static_cast<int>(std::min(source + 1 + rest, count));
+        auto wrapped = static_cast<int>(source + 1 + rest > count ? source + 1 + rest - count : 0);
+
+        // The fullest bank so far in each lane; a lane only moves on to a
+        // strictly fuller bank, so it holds the first of its fullest.
+        auto best = std::numeric_limits<int>::min();
+        auto bestIndex = size_t(0);
+        auto ii = size_t(0);
+
+        auto reduce = [&best, &bestIndex](const int* values, const int* indices, size_t lanes)
+        {
+            for (auto lane = size_t(0); lane < lanes; lane++)
+            {
+                auto index = static_cast<size_t>(indices[lane]);
+                if (values[lane] > best || (values[lane] == best && index < bestIndex))
+                {
+                    best = values[lane];
+                    bestIndex = index;
+                }
+            }
+        };
+
+        if (level == SimdLevel::Avx2 && count >= 8)
+        {
+            auto shareAll = _mm256_set1_epi32(share);
+            auto firstAll = _mm256_set1_epi32(first - 1);
+            auto lastAll = _mm256_set1_epi32(last);
+            auto wrappedAll = _mm256_set1_epi32(wrapped);
+            auto step = _mm256_set1_epi32(8);
+            auto index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+            auto maxValues = _mm256_set1_epi32(best);
+            auto maxIndices = _mm256_setzero_si256();
+
+            for (; ii + 8 <= count; ii += 8)
+            {
+                // Each one more bank has a mask of -1, taken from the share.
+                auto extra = _mm256_or_si256(
+                    _mm256_and_si256(_mm256_cmpgt_epi32(index, firstAll), _mm256_cmpgt_epi32(lastAll, index)),
+                    _mm256_cmpgt_epi32(wrappedAll, index));
+                auto values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(banks + ii));
+                values = _mm256_sub_epi32(_mm256_add_epi32(values, shareAll), extra);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(banks + ii), values);
+
+                auto fuller = _mm256_cmpgt_epi32(values, maxValues);
+                maxValues = _mm256_max_epi32(maxValues, values);
+                maxIndices = _mm256_blendv_epi8(maxIndices, index, fuller);
+                index = _mm256_add_epi32(index, step);
+            }
+
+            alignas(32) int values[8];
+            alignas(32) int indices[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(values), maxValues);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(indices), maxIndices);
+            reduce(values, indices, 8);
+        }
+        else if (level >= SimdLevel::Sse41 && count >= 4)
+        {
+            auto shareAll = _mm_set1_epi32(share);
+            auto firstAll = _mm_set1_epi32(first - 1);
+            auto lastAll = _mm_set1_epi32(last);
+            auto wrappedAll = _mm_set1_epi32(wrapped);
+            auto step = _mm_set1_epi32(4);
+            auto index = _mm_setr_epi32(0, 1, 2, 3);
+            auto maxValues = _mm_set1_epi32(best);
+            auto maxIndices = _mm_setzero_si128();
+
+            for (; ii + 4 <= count; ii += 4)
+            {
+                auto extra = _mm_or_si128(
+                    _mm_and_si128(_mm_cmpgt_epi32(index, firstAll), _mm_cmplt_epi32(index, lastAll)),
+                    _mm_cmplt_epi32(index, wrappedAll));
+                auto values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(banks + ii));
+                values = _mm_sub_epi32(_mm_add_epi32(values, shareAll), extra);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(banks + ii), values);
+
+                auto fuller = _mm_cmpgt_epi32(values, maxValues);
+                maxValues = _mm_max_epi32(maxValues, values);
+                maxIndices = _mm_blendv_epi8(maxIndices, index, fuller);
+                index = _mm_add_epi32(index, step);
+            }
+
+            alignas(16) int values[4];
+            alignas(16) int indices[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(values), maxValues);
+            _mm_store_si128(reinterpret_cast<__m128i*>(indices), maxIndices);
+            reduce(values, indices, 4);
+        }
+
+        for (; ii < count; ii++)
+        {
+            auto index = static_cast<int>(ii);
+            banks[ii] += share + ((index >= first && index < last) || index < wrapped ? 1 : 0);
+            if (banks[ii] > best)
+            {
+                best = banks[ii];
+                bestIndex = ii;
+            }
+        }
+
+        return bestIndex;
+    }
+
+    namespace
+    {
+        // The tables a hashed search keys configurations into, and the
+        // fingerprint weights, kept by the caller so that a run of searches
+        // can reuse them.
+        struct seenTables
+        {
+            seenTable<uint64_t> narrow;
+            seenTable<UInt128> wide;
+            std::vector<uint64_t> weights;
+        };
+
+        std::pair<size_t, size_t> FindLoop(const std::vector<int>& banks, LoopSearch search, seenTables& tables)
+        {
+            if (search == LoopSearch::Brent)
+            {
+                return SearchBrent(banks);
+            }
+
+            // No bank can hold more than every block, so that bounds the bits
+            // a bank needs.
+            auto total = uint64_t(0);
+            auto negative = false;
+            for (auto bank : banks)
+            {
+                negative |= bank < 0;
+                total += static_cast<uint64_t>(std::max(bank, 0));
+            }
+
+            auto width = size_t(1);
+            while (width < 64 && (total >> width) != 0)
+            {
+                width++;
+            }
+
+            if (!negative && banks.size() * width <= 64)
+            {
+                return SearchHashed(
+                    banks,
+                    tables.narrow,
+                    [width](const std::vector<int>& values)
+                    {
+                        auto key = uint64_t(0);
+                        for (auto ii = size_t(0); ii < values.size(); ii++)
+                        {
+                            key |= uint64_t(values[ii]) << (ii * width);
+                        }
+                        return key;
+                    },
+                    true);
+            }
+
+            if (!negative && banks.size() * width <= 128)
+            {
+                return SearchHashed(
+                    banks,
+                    tables.wide,
+                    [width](const std::vector<int>& values)
+                    {
+                        auto key = UInt128{ 0, 0 };
+                        for (auto ii = size_t(0); ii < values.size(); ii++)
+                        {
+                            auto value = uint64_t(values[ii]);
+                            auto position = ii * width;
+                            if (position >= 64)
+                            {
+                                key.high |= value << (position - 64);
+                                continue;
+                            }
+
+                            key.low |= value << position;
+                            if (position + width > 64)
+                            {
+                                key.high |= value >> (64 - position);
+                            }
+                        }
+                        return key;
+                    },
+                    true);
+            }
+
+            // A random odd weight per bank; the fingerprint is the weighted
+            // sum.
+            auto& weights = tables.weights;
+            for (auto ii = weights.size(); ii < banks.size(); ii++)
+            {
+                weights.push_back(Mix(ii + 1) | 1);
+            }
+
+            return SearchHashed(
+                banks,
+                tables.narrow,
+                [&weights](const std::vector<int>& values)
+                {
+                    auto fingerprint = uint64_t(0);
+                    for (auto ii = size_t(0); ii < values.size(); ii++)
+                    {
+                        fingerprint += uint64_t(int64_t(values[ii])) * weights[ii];
+                    }
+                    return fingerprint;
+                },
+                false);
+        }
+    }
+
+    std::pair<size_t, size_t> FindReallocationLoop(const std::vector<int>& banks, LoopSearch search)
+    {
+        seenTables tables;
+        return FindLoop(banks, search, tables);
+    }
+
+    std::vector<std::pair<size_t, size_t>> FindReallocationLoops(const std::vector<std::vector<int>>& configurations, ThreadPool& pool, LoopSearch search)
+    {
+        std::vector<std::pair<size_t, size_t>> loops(configurations.size());
+
+        // One set of tables per pool thread, grown to the largest search
+        // that thread runs and released with the batch.
+        std::vector<seenTables> tables(pool.Size());
+
+        pool.Run(
+            configurations.size(),
+            [&configurations, &loops, &tables, &pool, search](size_t index)
+            {
+                loops[index] = FindLoop(configurations[index], search, tables[pool.CurrentSlot()]);
+            });
+
+        return loops;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Simd.h"
+#include "Parallel.h"
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+namespace AdventOfCode2017
+{
+    // Day 6: one reallocation empties the fullest bank (the first of them on
+    // a tie) and deals its blocks out one at a time to the banks after it,
+    // wrapping around at the end.
+    void Reallocate(std::vector<int>& banks);
+
+    // The same reallocation from source, which must be the fullest bank, in
+    // one pass over the banks whatever the number of blocks: every bank gets
+    // blocks / count, and the blocks % count banks after source one more. The
+    // pass also finds the fullest bank afterwards, which it returns, so a run
+    // of reallocations needs no other search.
+    size_t Redistribute(int* banks, size_t count, size_t source, SimdLevel level = DetectSimdLevel());
+
+    enum class LoopSearch
+    {
+        // Brent's algorithm: keeps two configurations besides the start, at
+        // the cost of a few times as many reallocations as Hashed.
+        Brent,
+        // Keeps a key for every configuration seen in an open-addressing
+        // table. Bank values are packed into 64 or 128 bits when they fit;
+        // otherwise the key is a 64-bit fingerprint, and a match is checked
+        // against the earlier configuration, rebuilt from the start.
+        Hashed
+    };
+
+    // Reallocates from banks until a configuration repeats. Returns the number
+    // of distinct configurations seen before the repeat and the length of the
+    // loop it closes.
+    std::pair<size_t, size_t> FindReallocationLoop(const std::vector<int>& banks, LoopSearch search = LoopSearch::Hashed);
+
+    // FindReallocationLoop for every configuration, spread over pool, with
+    // the results in the same order. Each pool thread keeps its own tables
+    // for the length of the batch, clearing them between searches rather
+    // than allocating anew.
+    std::vector<std::pair<size_t, size_t>> FindReallocationLoops(const std::vector<std::vector<int>>& configurations, ThreadPool& pool = ThreadPool::Default(), LoopSearch search = LoopSearch::Hashed);
+}
\ No newline at end of file
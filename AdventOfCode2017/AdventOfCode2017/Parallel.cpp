@@ -0,0 +1,265 @@
+#include "stdafx.h"
+#include "Parallel.h"
+
+namespace AdventOfCode2017
+{
+    namespace
+    {
+        thread_local bool insidePool = false;
+
+        // The pool whose tasks this thread is running, and its slot there.
+        thread_local const ThreadPool* currentPool = nullptr;
+        thread_local size_t currentSlot = 0;
+
+        const size_t MinimumChunkBytes = 64 * 1024;
+    }
+
+    ThreadPool::ThreadPool(size_t threadCount) :
+        ranges(new taskRange[std::max(threadCount, size_t(1))]),
+        task(nullptr),
+        pendingWorkers(0),
+        generation(0),
+        stopping(false)
+    {
+        for (auto ii = size_t(0); ii < std::max(threadCount, size_t(1)); ii++)
+        {
+            ranges[ii].bounds = 0;
+        }
+
+        for (auto ii = size_t(1); ii < threadCount; ii++)
+        {
+            workers.emplace_back([this, ii]() { WorkerLoop(ii); });
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+
+        wake.notify_all();
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    size_t ThreadPool::DefaultThreadCount()
+    {
+        return std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    ThreadPool& ThreadPool::Default()
+    {
+        // Deliberately never destroyed: joining threads from a static
+        // destructor while the test DLL is unloading can deadlock.
+        static ThreadPool* pool = new ThreadPool();
+        return *pool;
+    }
+
+    void ThreadPool::Run(size_t count, const std::function<void(size_t)>& work)
+    {
+        if (workers.empty() || count <= 1 || insidePool)
+        {
+            for (auto ii = size_t(0); ii < count; ii++)
+            {
+                work(ii);
+            }
+
+            return;
+        }
+
+        // Ranges pack two 32-bit indices.
+        if (count > UINT32_MAX)
+        {
+            throw 1;
+        }
+
+        std::lock_guard<std::mutex> runLock(runMutex);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task = &work;
+
+            auto threads = Size();
+            for (auto ii = size_t(0); ii < threads; ii++)
+            {
+                auto first = uint64_t(count * ii / threads);
+                auto last = uint64_t(count * (ii + 1) / threads);
+                ranges[ii].bounds = first | (last << 32);
+            }
+
+            failure = nullptr;
+            pendingWorkers = workers.size();
+            generation++;
+        }
+
+        wake.notify_all();
+
+        insidePool = true;
+        currentPool = this;
+        currentSlot = 0;
+        Drain(0);
+        currentPool = nullptr;
+        insidePool = false;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this]() { return pendingWorkers == 0; });
+        task = nullptr;
+
+        if (failure)
+        {
+            std::rethrow_exception(failure);
+        }
+    }
+
+    size_t ThreadPool::CurrentSlot() const
+    {
+        // A batch run inline stays on one thread, so whatever slot it sees
+        // is unique within it.
+        return currentPool == this ? currentSlot : 0;
+    }
+
+    void ThreadPool::WorkerLoop(size_t self)
+    {
+        insidePool = true;
+        currentPool = this;
+        currentSlot = self;
+        auto seen = size_t(0);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            wake.wait(lock, [this, seen]() { return stopping || generation != seen; });
+
+            if (stopping)
+            {
+                return;
+            }
+
+            seen = generation;
+
+            lock.unlock();
+            Drain(self);
+            lock.lock();
+
+            if (--pendingWorkers == 0)
+            {
+                finished.notify_all();
+            }
+        }
+    }
+
+    void ThreadPool::Drain(size_t self)
+    {
+        while (true)
+        {
+            size_t index;
+            if (!TakeOwn(self, index) && !Steal(self, index))
+            {
+                return;
+            }
+
+            try
+            {
+                (*task)(index);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!failure)
+                {
+                    failure = std::current_exception();
+                }
+            }
+        }
+    }
+
+    bool ThreadPool::TakeOwn(size_t self, size_t& index)
+    {
+        auto& bounds = ranges[self].bounds;
+        auto current = bounds.load();
+
+        while (true)
+        {
+            auto first = current & UINT32_MAX;
+            auto last = current >> 32;
+            if (first >= last)
+            {
+                return false;
+            }
+
+            if (bounds.compare_exchange_weak(current, (first + 1) | (last << 32)))
+            {
+                index = static_cast<size_t>(first);
+                return true;
+            }
+        }
+    }
+
+    bool ThreadPool::Steal(size_t self, size_t& index)
+    {
+        auto threads = Size();
+        for (auto offset = size_t(1); offset < threads; offset++)
+        {
+            auto& bounds = ranges[(self + offset) % threads].bounds;
+            auto current = bounds.load();
+
+            while (true)
+            {
+                auto first = current & UINT32_MAX;
+                auto last = current >> 32;
+                if (first >= last)
+                {
+                    break;
+                }
+
+                auto middle = last - (last - first + 1) / 2;
+                if (bounds.compare_exchange_weak(current, first | (middle << 32)))
+                {
+                    // Only this thread refills its own range, and it is
+                    // empty, so thieves can at worst see it as still empty.
+                    ranges[self].bounds = (middle + 1) | (last << 32);
+                    index = static_cast<size_t>(middle);
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    std::vector<std::string_view> SplitChunks(std::string_view contents, size_t count)
+    {
+        std::vector<std::string_view> result;
+        count = std::max(count, size_t(1));
+
+        auto start = size_t(0);
+        for (auto ii = size_t(1); ii <= count && start < contents.size(); ii++)
+        {
+            auto end = contents.size();
+
+            if (ii < count)
+            {
+                auto target = std::max(start, contents.size() * ii / count);
+                auto newline = contents.find('\n', target);
+                end = newline != std::string_view::npos ? newline + 1 : contents.size();
+            }
+
+            result.push_back(contents.substr(start, end - start));
+            start = end;
+        }
+
+        return result;
+    }
+
+    size_t DefaultChunkCount(size_t bytes)
+    {
+        auto byThreads = ThreadPool::Default().Size() * 4;
+        auto bySize = std::max(bytes / MinimumChunkBytes, size_t(1));
+        return std::min(byThreads, bySize);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "Utilities.h"
+#include <vector>
+#include <memory>
+#include <string_view>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <type_traits>
+#include <iterator>
+#include <algorithm>
+#include <cstdint>
+
+namespace AdventOfCode2017
+{
+    // Fixed set of worker threads that cooperatively run batches of indexed
+    // tasks. The calling thread takes part in each batch, so Size() counts it.
+    //
+    // Each batch is dealt out as one contiguous range of task indices per
+    // thread. A thread works through its own range from the front, and once
+    // it is empty steals the back half of another thread's remaining range,
+    // so neighbouring tasks mostly stay on one thread while uneven tasks
+    // still balance.
+    class ThreadPool
+    {
+    public:
+        explicit ThreadPool(size_t threadCount = DefaultThreadCount());
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        size_t Size() const { return workers.size() + 1; }
+
+        // Runs task(0) .. task(taskCount - 1) across the pool and returns once
+        // all of them have finished. The first exception thrown by a task is
+        // rethrown here. Calls made from inside a running task execute inline.
+        void Run(size_t taskCount, const std::function<void(size_t)>& task);
+
+        // Which of this pool's threads is running the calling task, from 0
+        // (the thread that called Run) to Size() - 1. Tasks of one batch
+        // running at the same time always see different slots, so state
+        // indexed by slot needs no locking. Outside this pool's batches it
+        // is 0.
+        size_t CurrentSlot() const;
+
+        static size_t DefaultThreadCount();
+
+        static ThreadPool& Default();
+
+    private:
+        // A thread's remaining tasks, with the first index in the low half
+        // and one past the last in the high half, so that the owner taking
+        // from the front and thieves taking from the back both need only a
+        // single compare-and-swap.
+        struct alignas(64) taskRange
+        {
+            std::atomic<uint64_t> bounds;
+        };
+
+        void WorkerLoop(size_t self);
+        void Drain(size_t self);
+        bool TakeOwn(size_t self, size_t& index);
+        bool Steal(size_t self, size_t& index);
+
+        std::vector<std::thread> workers;
+        std::unique_ptr<taskRange[]> ranges;
+        std::mutex runMutex;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable finished;
+        const std::function<void(size_t)>* task;
+        size_t pendingWorkers;
+        size_t generation;
+        bool stopping;
+        std::exception_ptr failure;
+    };
+
+    // Splits contents into at most count pieces of roughly equal size whose
+    // boundaries fall just after a newline.
+    std::vector<std::string_view> SplitChunks(std::string_view contents, size_t count);
+
+    size_t DefaultChunkCount(size_t bytes);
+
+    template<class T>
+    std::vector<T> Concatenate(std::vector<std::vector<T>>& parts)
+    {
+        auto total = size_t(0);
+        for (auto& part : parts)
+        {
+            total += part.size();
+        }
+
+        std::vector<T> result;
+        result.reserve(total);
+
+        for (auto& part : parts)
+        {
+            std::move(part.begin(), part.end(), std::back_inserter(result));
+        }
+
+        return result;
+    }
+
+    // Parses every line of contents with parser on the default pool. Each chunk
+    // collects into its own vector; the chunks are concatenated in file order,
+    // so the result matches a sequential parse line for line.
+    template<class Parser>
+    auto ParallelParseLines(std::string_view contents, Parser parser, size_t chunkCount = 0)
+    {
+        using Result = std::decay_t<decltype(parser(std::string_view()))>;
+
+        auto chunks = SplitChunks(contents, chunkCount != 0 ? chunkCount : DefaultChunkCount(contents.size()));
+        std::vector<std::vector<Result>> parts(chunks.size());
+
+        ThreadPool::Default().Run(
+            chunks.size(),
+            [&chunks, &parts, &parser](size_t index)
+            {
+                auto& part = parts[index];
+                ForEachLine(chunks[index], [&part, &parser](std::string_view line) { part.push_back(parser(line)); });
+            });
+
+        return Concatenate(parts);
+    }
+
+    // Same as ParallelParseLines for lines that have already been split, such
+    // as MappedInput::Lines or an in-memory vector of strings.
+    template<class Lines, class Parser>
+    auto ParallelParse(const Lines& lines, Parser parser, size_t chunkCount = 0)
+    {
+        using Result = std::decay_t<decltype(parser(*std::begin(lines)))>;
+
+        auto count = static_cast<size_t>(std::distance(std::begin(lines), std::end(lines)));
+        chunkCount = std::min(count, chunkCount != 0 ? chunkCount : ThreadPool::Default().Size() * 4);
+        std::vector<std::vector<Result>> parts(chunkCount);
+
+        ThreadPool::Default().Run(
+            chunkCount,
+            [&lines, &parts, &parser, count, chunkCount](size_t index)
+            {
+                auto first = std::next(std::begin(lines), count * index / chunkCount);
+                auto last = std::next(std::begin(lines), count * (index + 1) / chunkCount);
+                auto& part = parts[index];
+                part.reserve(std::distance(first, last));
+                std::transform(first, last, std::back_inserter(part), parser);
+            });
+
+        return Concatenate(parts);
+    }
+}
\ No newline at end of file
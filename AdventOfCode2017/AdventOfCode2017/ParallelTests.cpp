@@ -0,0 +1,104 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "Parallel.h"
+#include "ParseInt.h"
+#include <vector>
+#include <string>
+#include <string_view>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace AdventOfCode2017
+{
+    TEST_CLASS(Parallel)
+    {
+    private:
+        static std::vector<int> parseNumbers(std::string_view line)
+        {
+            std::vector<int> numbers;
+            if (ParseIntList(line, numbers).error != ParseError::None)
+            {
+                throw 1;
+            }
+
+            return numbers;
+        }
+
+    public:
+        TEST_METHOD(Parallel_Test1)
+        {
+            std::string input = "0 <-> 2\n1 <-> 1\r\n2 <-> 0, 3, 4\n3 <-> 2, 4\n4 <-> 2, 3, 6\n5 <-> 6\n6 <-> 4, 5";
+
+            auto chunks = SplitChunks(input, 3);
+            Assert::AreEqual(size_t(3), chunks.size());
+            Assert::AreEqual(input.size(), chunks[0].size() + chunks[1].size() + chunks[2].size());
+            Assert::AreEqual('\n', chunks[0].back());
+            Assert::AreEqual('\n', chunks[1].back());
+
+            auto sequential = SplitLines(input);
+            for (auto chunkCount = size_t(1); chunkCount <= 8; chunkCount++)
+            {
+                auto parsed = ParallelParseLines(input, parseNumbers, chunkCount);
+                Assert::AreEqual(sequential.size(), parsed.size());
+                for (auto ii = size_t(0); ii < parsed.size(); ii++)
+                {
+                    Assert::IsTrue(parseNumbers(sequential[ii]) == parsed[ii]);
+                }
+            }
+        }
+
+        TEST_METHOD(Parallel_Test2)
+        {
+            // Each slot is marked busy while its task runs; a second task
+            // finding it busy means two threads shared a slot.
+            ThreadPool pool(4);
+            std::vector<std::atomic<bool>> busy(pool.Size());
+            std::atomic<bool> shared(false);
+            std::atomic<bool> outOfRange(false);
+            std::vector<size_t> slots(1000);
+
+            pool.Run(
+                slots.size(),
+                [&](size_t index)
+                {
+                    auto slot = pool.CurrentSlot();
+                    slots[index] = slot;
+                    if (slot >= busy.size())
+                    {
+                        outOfRange = true;
+                        return;
+                    }
+
+                    if (busy[slot].exchange(true))
+                    {
+                        shared = true;
+                    }
+
+                    std::this_thread::yield();
+                    busy[slot] = false;
+                });
+
+            Assert::IsFalse(outOfRange);
+            Assert::IsFalse(shared);
+            Assert::AreEqual(size_t(0), pool.CurrentSlot());
+
+            // A batch run inline from inside a task keeps the slot of the
+            // thread it runs on.
+            std::vector<size_t> nested(8);
+            pool.Run(
+                nested.size(),
+                [&](size_t index)
+                {
+                    auto outer = pool.CurrentSlot();
+                    auto same = true;
+                    pool.Run(4, [&](size_t) { same &= pool.CurrentSlot() == outer; });
+                    nested[index] = same ? 1 : 0;
+                });
+
+            Assert::IsTrue(std::all_of(nested.begin(), nested.end(), [](size_t value) { return value == 1; }));
+        }
+    };
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "stdafx.h"
+#include "ParseCache.h"
+#include <atomic>
+#include <fstream>
+#include <cstdio>
+
+namespace AdventOfCode2017
+{
+    namespace
+    {
+        const uint32_t CacheMagic = 0x43434F41; // "AOCC"
+        const uint32_t CacheFormatVersion = 1;
+
+        struct cacheHeader
+        {
+            uint32_t magic;
+            uint32_t formatVersion;
+            uint32_t schemaVersion;
+            uint32_t reserved;
+            uint64_t sourceHash;
+            uint64_t payloadSize;
+        };
+
+        std::atomic<size_t> cacheHits(0);
+        std::atomic<size_t> cacheMisses(0);
+    }
+
+    uint64_t HashContents(std::string_view contents, uint64_t seed)
+    {
+        // FNV-1a style, but a word at a time with a fold so the high bits of
+        // each word still reach the low bits of the hash.
+        const auto prime = 0x100000001B3ull;
+        auto hash = (seed ^ 0xCBF29CE484222325ull) * prime;
+
+        auto data = contents.data();
+        auto remaining = contents.size();
+
+        for (; remaining >= sizeof(uint64_t); data += sizeof(uint64_t), remaining -= sizeof(uint64_t))
+        {
+            uint64_t word;
+            memcpy(&word, data, sizeof(word));
+            hash = (hash ^ word) * prime;
+            hash ^= hash >> 32;
+        }
+
+        for (; remaining > 0; data++, remaining--)
+        {
+            hash = (hash ^ static_cast<unsigned char>(*data)) * prime;
+        }
+
+        return (hash ^ contents.size()) * prime;
+    }
+
+    ParseCacheCounters GetParseCacheCounters()
+    {
+        return ParseCacheCounters{ cacheHits.load(), cacheMisses.load() };
+    }
+
+    void CountParseCache(bool hit)
+    {
+        (hit ? cacheHits : cacheMisses)++;
+    }
+
+    std::optional<MappedInput> OpenParseCache(const std::string& cacheFile, uint64_t sourceHash, uint32_t schemaVersion, std::string_view& payload)
+    {
+        std::optional<MappedInput> cache;
+
+        try
+        {
+            cache.emplace(cacheFile);
+        }
+        catch (int)
+        {
+            return std::nullopt;
+        }
+
+        auto contents = cache->Contents();
+        if (contents.size() < sizeof(cacheHeader))
+        {
+            return std::nullopt;
+        }
+
+        cacheHeader header;
+        memcpy(&header, contents.data(), sizeof(header));
+
+        if (header.magic != CacheMagic ||
+            header.formatVersion != CacheFormatVersion ||
+            header.schemaVersion != schemaVersion ||
+            header.sourceHash != sourceHash ||
+            header.payloadSize != contents.size() - sizeof(header))
+        {
+            return std::nullopt;
+        }
+
+        payload = contents.substr(sizeof(header));
+        return cache;
+    }
+
+    void WriteParseCache(const std::string& cacheFile, uint64_t sourceHash, uint32_t schemaVersion, const std::string& payload)
+    {
+        cacheHeader header = { CacheMagic, CacheFormatVersion, schemaVersion, 0, sourceHash, payload.size() };
+
+        // Write everything to a side file first so a reader never maps a
+        // half-written cache under the real name.
+        auto tempFile = cacheFile + ".tmp";
+
+        {
+            std::ofstream output(tempFile, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (output.fail())
+            {
+                return;
+            }
+
+            output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            output.write(payload.data(), payload.size());
+
+            if (output.fail())
+            {
+                output.close();
+                std::remove(tempFile.c_str());
+                return;
+            }
+        }
+
+        std::remove(cacheFile.c_str());
+        if (std::rename(tempFile.c_str(), cacheFile.c_str()) != 0)
+        {
+            std::remove(tempFile.c_str());
+        }
+    }
+}
\ No newline at end of file
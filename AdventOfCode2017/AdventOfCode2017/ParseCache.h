@@ -0,0 +1,173 @@
+#pragma once
+
+#include "Utilities.h"
+#include <vector>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <type_traits>
+#include <cstdint>
+#include <cstring>
+
+namespace AdventOfCode2017
+{
+    // 64-bit fingerprint of input text, used to key cached parse results.
+    uint64_t HashContents(std::string_view contents, uint64_t seed = 0);
+
+    template<class Lines>
+    uint64_t HashLines(const Lines& lines)
+    {
+        auto hash = uint64_t(0);
+        for (auto& line : lines)
+        {
+            hash = HashContents(line, hash);
+        }
+
+        return hash;
+    }
+
+    class BinaryWriter
+    {
+    public:
+        template<class T>
+        void Write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only raw values can be written directly");
+            buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        void WriteString(std::string_view value)
+        {
+            Write(static_cast<uint32_t>(value.size()));
+            buffer.append(value.data(), value.size());
+        }
+
+        template<class T>
+        void WriteVector(const std::vector<T>& values)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only raw values can be written directly");
+            Write(static_cast<uint64_t>(values.size()));
+            buffer.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+        }
+
+        const std::string& Buffer() const { return buffer; }
+
+    private:
+        std::string buffer;
+    };
+
+    // Reads values back out of a BinaryWriter buffer. Running past the end
+    // throws, so truncated or corrupt cache files are rejected.
+    class BinaryReader
+    {
+    public:
+        explicit BinaryReader(std::string_view contents) : data(contents), position(0) { }
+
+        template<class T>
+        T Read()
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only raw values can be read directly");
+            T value;
+            memcpy(&value, Take(sizeof(T)), sizeof(T));
+            return value;
+        }
+
+        std::string_view ReadString()
+        {
+            auto size = Read<uint32_t>();
+            return std::string_view(Take(size), size);
+        }
+
+        template<class T>
+        std::vector<T> ReadVector()
+        {
+            auto count = Read<uint64_t>();
+            if (count > (data.size() - position) / sizeof(T))
+            {
+                throw 1;
+            }
+
+            std::vector<T> values(static_cast<size_t>(count));
+            memcpy(values.data(), Take(values.size() * sizeof(T)), values.size() * sizeof(T));
+            return values;
+        }
+
+        bool AtEnd() const { return position == data.size(); }
+
+    private:
+        const char* Take(size_t size)
+        {
+            if (size > data.size() - position)
+            {
+                throw 1;
+            }
+
+            auto result = data.data() + position;
+            position += size;
+            return result;
+        }
+
+        std::string_view data;
+        size_t position;
+    };
+
+    struct ParseCacheCounters
+    {
+        size_t hits;
+        size_t misses;
+    };
+
+    ParseCacheCounters GetParseCacheCounters();
+
+    // Maps cacheFile and returns its payload if the file is intact and was
+    // written for the same source hash and schema version.
+    std::optional<MappedInput> OpenParseCache(const std::string& cacheFile, uint64_t sourceHash, uint32_t schemaVersion, std::string_view& payload);
+
+    // Best effort: a cache that cannot be written just means parsing again
+    // next time.
+    void WriteParseCache(const std::string& cacheFile, uint64_t sourceHash, uint32_t schemaVersion, const std::string& payload);
+
+    void CountParseCache(bool hit);
+
+    // Returns load(reader) from cacheFile when it matches sourceHash and
+    // schemaVersion; otherwise returns parse() and rewrites the cache with
+    // save(writer, result). Bump schemaVersion whenever save/load change.
+    template<class Parse, class Save, class Load>
+    auto CachedParse(uint64_t sourceHash, const std::string& cacheFile, uint32_t schemaVersion, Parse parse, Save save, Load load)
+    {
+        using Result = decltype(parse());
+
+        std::string_view payload;
+        auto cache = OpenParseCache(cacheFile, sourceHash, schemaVersion, payload);
+
+        if (cache)
+        {
+            try
+            {
+                BinaryReader reader(payload);
+                Result result = load(reader);
+
+                if (reader.AtEnd())
+                {
+                    CountParseCache(true);
+                    return result;
+                }
+            }
+            catch (int)
+            {
+            }
+
+            cache.reset();
+        }
+
+        CountParseCache(false);
+
+        Result result = parse();
+
+        BinaryWriter writer;
+        save(writer, result);
+        WriteParseCache(cacheFile, sourceHash, schemaVersion, writer.Buffer());
+
+        return result;
+    }
+}
\ No newline at end of file
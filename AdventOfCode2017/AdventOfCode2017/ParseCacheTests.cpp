@@ -0,0 +1,59 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "ParseCache.h"
+#include <vector>
+#include <string>
+#include <filesystem>
+#include <cstdio>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace AdventOfCode2017
+{
+    TEST_CLASS(ParseCache)
+    {
+    private:
+        static std::vector<int32_t> parseTwice(const std::string& source, const std::string& cacheFile, size_t& parses)
+        {
+            return CachedParse(
+                HashContents(source),
+                cacheFile,
+                1,
+                [&source, &parses]()
+                {
+                    parses++;
+                    return std::vector<int32_t>(source.begin(), source.end());
+                },
+                [](BinaryWriter& writer, const std::vector<int32_t>& values) { writer.WriteVector(values); },
+                [](BinaryReader& reader) { return reader.ReadVector<int32_t>(); });
+        }
+
+    public:
+        TEST_METHOD(ParseCache_Test1)
+        {
+            // The first parse finds no cache and writes one; the second reads
+            // it back without parsing.
+            const auto cacheFile = (std::filesystem::temp_directory_path() / "ParseCache-counters.cache").string();
+            const std::string source = "5 1 9 5";
+            std::remove(cacheFile.c_str());
+
+            auto parses = size_t(0);
+            auto before = GetParseCacheCounters();
+
+            auto first = parseTwice(source, cacheFile, parses);
+            auto afterFirst = GetParseCacheCounters();
+            Assert::AreEqual(size_t(1), afterFirst.misses - before.misses);
+            Assert::AreEqual(size_t(0), afterFirst.hits - before.hits);
+
+            auto second = parseTwice(source, cacheFile, parses);
+            auto afterSecond = GetParseCacheCounters();
+            Assert::AreEqual(size_t(1), afterSecond.misses - before.misses);
+            Assert::AreEqual(size_t(1), afterSecond.hits - before.hits);
+
+            std::remove(cacheFile.c_str());
+
+            Assert::AreEqual(size_t(1), parses);
+            Assert::IsTrue(first == second);
+        }
+    };
+}
\ No newline at end of file
@@ -0,0 +1,259 @@
+#include "stdafx.h"
+#include "ParseInt.h"
+#include "Simd.h"
+#include <limits>
+#include <cstring>
+#include <intrin.h>
+
+namespace AdventOfCode2017
+{
+    namespace
+    {
+        const uint64_t PowersOfTen[] =
+        {
+            1ull,
+            10ull,
+            100ull,
+            1000ull,
+            10000ull,
+            100000ull,
+            1000000ull,
+            10000000ull,
+            100000000ull,
+        };
+
+        // Loads up to eight bytes little-endian; bytes past last read as zero,
+        // which is not a digit.
+        uint64_t LoadEight(const char* first, const char* last)
+        {
+            auto word = uint64_t(0);
+            auto available = static_cast<size_t>(last - first);
+            memcpy(&word, first, available < sizeof(word) ? available : sizeof(word));
+            return word;
+        }
+
+        // Number of leading bytes of word that are ASCII digits.
+        unsigned CountDigits(uint64_t word)
+        {
+            // A digit has high nibble 3 both before and after adding 6. A carry
+            // out of a byte can only come from a non-digit, and only disturbs
+            // bytes after it, which are never counted.
+            auto high = (word & 0xF0F0F0F0F0F0F0F0ull) ^ 0x3030303030303030ull;
+            auto low = ((word + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) ^ 0x3030303030303030ull;
+            auto bad = high | low;
+
+            auto flags = (((bad & 0x7F7F7F7F7F7F7F7Full) + 0x7F7F7F7F7F7F7F7Full) | bad) & 0x8080808080808080ull;
+            return flags == 0 ? 8 : TrailingZeroBits(flags) / 8;
+        }
+
+        // Converts the first count (1..8) digit bytes of word.
+        uint32_t ConvertDigits(uint64_t word, unsigned count)
+        {
+            // Shift the digits to the top so the missing ones read as leading zeros.
+            word = (word - 0x3030303030303030ull) << (8 * (8 - count));
+
+            word = (word * 10) + (word >> 8);
+            word = (((word & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) +
+                (((word >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;
+
+            return static_cast<uint32_t>(word);
+        }
+
+        bool IsDigit(char ch)
+        {
+            return static_cast<unsigned char>(ch - '0') <= 9;
+        }
+
+        bool StartsNumber(const char* cursor, const char* last)
+        {
+            return IsDigit(*cursor) ||
+                ((*cursor == '-' || *cursor == '+') && cursor + 1 < last && IsDigit(cursor[1]));
+        }
+
+        template<class T>
+        ParseResult ParseSigned(std::string_view text, T& value)
+        {
+            auto first = text.data();
+            auto last = first + text.size();
+            auto cursor = first;
+
+            auto negative = false;
+            if (cursor < last && (*cursor == '-' || *cursor == '+'))
+            {
+                negative = *cursor == '-';
+                cursor++;
+            }
+
+            const auto limit = static_cast<uint64_t>(std::numeric_limits<T>::max()) + (negative ? 1 : 0);
+            auto magnitude = uint64_t(0);
+            auto digits = size_t(0);
+            auto overflow = false;
+
+            while (cursor < last)
+            {
+                auto word = LoadEight(cursor, last);
+                auto count = CountDigits(word);
+
+                if (count == 0)
+                {
+                    break;
+                }
+
+                auto chunk = ConvertDigits(word, count);
+
+                if (overflow || magnitude > (limit - chunk) / PowersOfTen[count])
+                {
+                    overflow = true;
+                }
+                else
+                {
+                    magnitude = magnitude * PowersOfTen[count] + chunk;
+                }
+
+                cursor += count;
+                digits += count;
+
+                if (count < 8)
+                {
+                    break;
+                }
+            }
+
+            if (digits == 0)
+            {
+                return ParseResult{ first, ParseError::NoDigits };
+            }
+
+            if (overflow)
+            {
+                return ParseResult{ cursor, ParseError::Overflow };
+            }
+
+            // Negate through magnitude - 1 so the minimum value never overflows.
+            value = negative ?
+                static_cast<T>(-static_cast<int64_t>(magnitude - 1) - 1) :
+                static_cast<T>(magnitude);
+
+            return ParseResult{ cursor, ParseError::None };
+        }
+
+        template<class T>
+        ParseError Consume(std::string_view& text, T& value)
+        {
+            auto result = ParseSigned(text, value);
+
+            if (result.error == ParseError::None)
+            {
+                text.remove_prefix(result.next - text.data());
+            }
+
+            return result.error;
+        }
+
+        template<class T, class Store>
+        ParseListResult ParseList(std::string_view text, Store store)
+        {
+            auto cursor = text.data();
+            auto last = cursor + text.size();
+            auto count = size_t(0);
+
+            while (true)
+            {
+                while (cursor < last && !StartsNumber(cursor, last))
+                {
+                    cursor++;
+                }
+
+                if (cursor == last)
+                {
+                    return ParseListResult{ count, cursor, ParseError::None };
+                }
+
+                T value;
+                auto result = ParseSigned(std::string_view(cursor, last - cursor), value);
+
+                if (result.error != ParseError::None)
+                {
+                    return ParseListResult{ count, result.next, result.error };
+                }
+
+                if (!store(count, value))
+                {
+                    return ParseListResult{ count, cursor, ParseError::BufferFull };
+                }
+
+                count++;
+                cursor = result.next;
+            }
+        }
+
+        template<class T>
+        ParseListResult ParseIntoBuffer(std::string_view text, T* output, size_t capacity)
+        {
+            return ParseList<T>(
+                text,
+                [output, capacity](size_t index, T value)
+                {
+                    if (index >= capacity)
+                    {
+                        return false;
+                    }
+
+                    output[index] = value;
+                    return true;
+                });
+        }
+
+        template<class T>
+        ParseListResult ParseIntoVector(std::string_view text, std::vector<T>& output)
+        {
+            return ParseList<T>(
+                text,
+                [&output](size_t, T value)
+                {
+                    output.push_back(value);
+                    return true;
+                });
+        }
+    }
+
+    ParseResult ParseInt32(std::string_view text, int32_t& value)
+    {
+        return ParseSigned(text, value);
+    }
+
+    ParseResult ParseInt64(std::string_view text, int64_t& value)
+    {
+        return ParseSigned(text, value);
+    }
+
+    ParseError ConsumeInt32(std::string_view& text, int32_t& value)
+    {
+        return Consume(text, value);
+    }
+
+    ParseError ConsumeInt64(std::string_view& text, int64_t& value)
+    {
+        return Consume(text, value);
+    }
+
+    ParseListResult ParseIntList(std::string_view text, int32_t* output, size_t capacity)
+    {
+        return ParseIntoBuffer(text, output, capacity);
+    }
+
+    ParseListResult ParseIntList(std::string_view text, int64_t* output, size_t capacity)
+    {
+        return ParseIntoBuffer(text, output, capacity);
+    }
+
+    ParseListResult ParseIntList(std::string_view text, std::vector<int32_t>& output)
+    {
+        return ParseIntoVector(text, output);
+    }
+
+    ParseListResult ParseIntList(std::string_view text, std::vector<int64_t>& output)
+    {
+        return ParseIntoVector(text, output);
+    }
+}
\ No newline at end of file
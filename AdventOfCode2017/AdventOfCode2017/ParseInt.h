@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace AdventOfCode2017
+{
+    enum class ParseError
+    {
+        None = 0,
+        NoDigits = 1,
+        Overflow = 2,
+        BufferFull = 3,
+    };
+
+    struct ParseResult
+    {
+        // First character that was not consumed. On NoDigits this is the
+        // start of the text; on Overflow it is just past the digits.
+        const char* next;
+        ParseError error;
+    };
+
+    struct ParseListResult
+    {
+        size_t count;
+        const char* next;
+        ParseError error;
+    };
+
+    // Parses an optionally signed decimal integer at the start of text, eight
+    // digits per step using SWAR arithmetic. value is only written on success.
+    ParseResult ParseInt32(std::string_view text, int32_t& value);
+    ParseResult ParseInt64(std::string_view text, int64_t& value);
+
+    // As ParseInt32/ParseInt64, advancing text past the number on success.
+    ParseError ConsumeInt32(std::string_view& text, int32_t& value);
+    ParseError ConsumeInt64(std::string_view& text, int64_t& value);
+
+    // Parses every integer in text, treating any run of characters that cannot
+    // start a number (spaces, commas, ':', "<->", ...) as a separator. When
+    // the buffer fills up, parsing stops with BufferFull and next points at
+    // the first number that did not fit, so the caller can continue from it.
+    ParseListResult ParseIntList(std::string_view text, int32_t* output, size_t capacity);
+    ParseListResult ParseIntList(std::string_view text, int64_t* output, size_t capacity);
+
+    // Appends every integer in text to output.
+    ParseListResult ParseIntList(std::string_view text, std::vector<int32_t>& output);
+    ParseListResult ParseIntList(std::string_view text, std::vector<int64_t>& output);
+}
\ No newline at end of file
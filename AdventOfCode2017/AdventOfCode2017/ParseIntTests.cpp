@@ -0,0 +1,80 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "ParseInt.h"
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace AdventOfCode2017
+{
+    TEST_CLASS(ParseInt)
+    {
+    public:
+        TEST_METHOD(ParseInt_Test1)
+        {
+            const std::string valid[] = { "0", "-3", "+7", "12345678", "123456789", "2147483647", "-2147483648", "000000000042" };
+            const int expected[] = { 0, -3, 7, 12345678, 123456789, 2147483647, -2147483647 - 1, 42 };
+
+            for (auto i = 0; i < 8; i++)
+            {
+                int value;
+                auto result = ParseInt32(valid[i], value);
+                Assert::IsTrue(result.error == ParseError::None);
+                Assert::IsTrue(result.next == valid[i].data() + valid[i].size());
+                Assert::AreEqual(expected[i], value);
+            }
+
+            int value = 5;
+            std::string_view text = "2147483648 ";
+            auto result = ParseInt32(text, value);
+            Assert::IsTrue(result.error == ParseError::Overflow);
+            Assert::IsTrue(result.next == text.data() + 10);
+            Assert::AreEqual(5, value);
+
+            Assert::IsTrue(ParseInt32("-2147483649", value).error == ParseError::Overflow);
+            Assert::IsTrue(ParseInt32("-", value).error == ParseError::NoDigits);
+            Assert::IsTrue(ParseInt32(" 1", value).error == ParseError::NoDigits);
+            Assert::IsTrue(ParseInt32("", value).error == ParseError::NoDigits);
+
+            text = "-42abc";
+            Assert::IsTrue(ConsumeInt32(text, value) == ParseError::None);
+            Assert::AreEqual(-42, value);
+            Assert::IsTrue(text == "abc");
+
+            int64_t wide;
+            Assert::IsTrue(ParseInt64("9223372036854775807", wide).error == ParseError::None);
+            Assert::IsTrue(wide == INT64_MAX);
+            Assert::IsTrue(ParseInt64("-9223372036854775808", wide).error == ParseError::None);
+            Assert::IsTrue(wide == INT64_MIN);
+            Assert::IsTrue(ParseInt64("9223372036854775808", wide).error == ParseError::Overflow);
+        }
+
+        TEST_METHOD(ParseInt_Test2)
+        {
+            int values[3];
+            std::string_view text = "2 <-> 0, -3,\t4: 5";
+
+            auto result = ParseIntList(text, values, 3);
+            Assert::IsTrue(result.error == ParseError::BufferFull);
+            Assert::AreEqual(size_t(3), result.count);
+            Assert::AreEqual(2, values[0]);
+            Assert::AreEqual(0, values[1]);
+            Assert::AreEqual(-3, values[2]);
+
+            result = ParseIntList(text.substr(result.next - text.data()), values, 3);
+            Assert::IsTrue(result.error == ParseError::None);
+            Assert::AreEqual(size_t(2), result.count);
+            Assert::AreEqual(4, values[0]);
+            Assert::AreEqual(5, values[1]);
+
+            std::vector<int64_t> wide;
+            Assert::IsTrue(ParseIntList("1, 99999999999 -7", wide).error == ParseError::None);
+            Assert::AreEqual(size_t(3), wide.size());
+            Assert::IsTrue(wide[1] == 99999999999);
+            Assert::IsTrue(wide[2] == -7);
+        }
+    };
+}
\ No newline at end of file
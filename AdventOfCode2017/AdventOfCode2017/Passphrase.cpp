@@ -0,0 +1,390 @@
+#include "stdafx.h"
+#include "Passphrase.h"
+#include "ParseCache.h"
+#include "Utilities.h"
+#include <algorithm>
+#include <vector>
+#include <cstring>
+#include <intrin.h>
+
+namespace AdventOfCode2017
+{
+    namespace
+    {
+        const size_t StackWords = 64;
+        const size_t ChunkBytes = 256 * 1024;
+        const std::string_view Delimiters = " \r\n";
+
+        // What each byte adds to the three words of a LetterSignature, so
+        // that building one needs no branches or variable shifts.
+        struct letterTable
+        {
+            uint64_t increments[3][256];
+            uint8_t isLetter[256];
+        };
+
+        const letterTable& LetterTable()
+        {
+            static const letterTable table = []()
+            {
+                letterTable result = {};
+                for (auto letter = 0; letter < 26; letter++)
+                {
+                    auto byte = static_cast<unsigned char>('a' + letter);
+                    auto part = letter / 12;
+                    result.increments[part][byte] = uint64_t(1) << (5 * (letter - 12 * part));
+                    result.isLetter[byte] = 1;
+                }
+                return result;
+            }();
+
+            return table;
+        }
+
+        struct wordKey
+        {
+            uint64_t hash;
+            std::string_view word;
+            LetterSignature signature;
+        };
+
+        uint64_t KeyOf(std::string_view word, PassphraseRule rule, LetterSignature& signature)
+        {
+            if (rule == PassphraseRule::NoDuplicates)
+            {
+                return Mix(HashContents(word));
+            }
+
+            signature = SignatureOf(word);
+            if (signature.exact)
+            {
+                return Mix(signature.counts[0] + signature.counts[1] * 0x9E3779B97F4A7C15ull + signature.counts[2] * 0xC2B2AE3D27D4EB4Full);
+            }
+
+            // A sum does not depend on the order of the bytes, so anagrams
+            // still share a key.
+            auto hash = uint64_t(word.size());
+            for (auto c : word)
+            {
+                hash += Mix(static_cast<unsigned char>(c) + 1);
+            }
+
+            return Mix(hash);
+        }
+
+        bool Equivalent(const wordKey& left, const wordKey& right, PassphraseRule rule)
+        {
+            if (left.hash != right.hash)
+            {
+                return false;
+            }
+
+            if (rule == PassphraseRule::NoDuplicates)
+            {
+                return left.word == right.word;
+            }
+
+            if (left.signature.exact && right.signature.exact)
+            {
+                return std::equal(left.signature.counts, left.signature.counts + 3, right.signature.counts);
+            }
+
+            return !left.signature.exact && !right.signature.exact && AreAnagrams(left.word, right.word);
+        }
+
+        // Finds repeated words in a list with an open-addressing table whose
+        // slots hold a word's index plus one, or zero when empty. Lists of up
+        // to StackWords words use the arrays inside the object, so keeping
+        // one on the stack or reusing it avoids allocation.
+        class repeatFinder
+        {
+        public:
+            bool HasRepeat(const std::string_view* words, size_t count, PassphraseRule rule)
+            {
+                auto keys = stackKeys;
+                auto slots = stackSlots;
+
+                // Sized to the list so short lines clear only a few slots.
+                auto capacity = size_t(8);
+                while (capacity < count)
+                {
+                    capacity *= 2;
+                }
+
+                if (capacity > StackWords)
+                {
+                    heapKeys.resize(capacity);
+                    heapSlots.resize(2 * capacity);
+                    keys = heapKeys.data();
+                    slots = heapSlots.data();
+                }
+
+                auto mask = 2 * capacity - 1;
+                std::fill(slots, slots + 2 * capacity, 0);
+
+                for (auto ii = size_t(0); ii < count; ii++)
+                {
+                    auto& key = keys[ii];
+                    key.word = words[ii];
+                    key.hash = KeyOf(key.word, rule, key.signature);
+
+                    for (auto slot = key.hash & mask; ; slot = (slot + 1) & mask)
+                    {
+                        if (slots[slot] == 0)
+                        {
+                            slots[slot] = static_cast<uint32_t>(ii + 1);
+                            break;
+                        }
+
+                        if (Equivalent(keys[slots[slot] - 1], key, rule))
+                        {
+                            return true;
+                        }
+                    }
+                }
+
+                return false;
+            }
+
+        private:
+            wordKey stackKeys[StackWords];
+            uint32_t stackSlots[2 * StackWords];
+            std::vector<wordKey> heapKeys;
+            std::vector<uint32_t> heapSlots;
+        };
+
+        // Bit i of the result is set when block[i] is a delimiter, and bit i
+        // of newlines when it is '\n'.
+        uint64_t ClassifyBlock(const char* block, SimdLevel level, uint64_t& newlines)
+        {
+            switch (level)
+            {
+            case SimdLevel::Avx2:
+            {
+                auto delimiters = uint64_t(0);
+                newlines = 0;
+                for (auto half = 0; half < 2; half++)
+                {
+                    auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32 * half));
+                    auto newline = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n'));
+                    auto other = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\r')));
+                    newlines |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(newline))) << (32 * half);
+                    delimiters |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(newline, other)))) << (32 * half);
+                }
+                return delimiters;
+            }
+            case SimdLevel::Sse41:
+            {
+                auto delimiters = uint64_t(0);
+                newlines = 0;
+                for (auto quarter = 0; quarter < 4; quarter++)
+                {
+                    auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * quarter));
+                    auto newline = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n'));
+                    auto other = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\r')));
+                    newlines |= uint64_t(static_cast<uint32_t>(_mm_movemask_epi8(newline))) << (16 * quarter);
+                    delimiters |= uint64_t(static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(newline, other)))) << (16 * quarter);
+                }
+                return delimiters;
+            }
+            default:
+            {
+                auto delimiters = uint64_t(0);
+                newlines = 0;
+                for (auto ii = 0; ii < 64; ii++)
+                {
+                    auto c = block[ii];
+                    newlines |= uint64_t(c == '\n' ? 1 : 0) << ii;
+                    delimiters |= uint64_t(c == '\n' || c == ' ' || c == '\r' ? 1 : 0) << ii;
+                }
+                return delimiters;
+            }
+            }
+        }
+
+        // Calls action with the words of each line of contents, 64 bytes at
+        // a time: word starts are non-delimiters after a delimiter and word
+        // ends are delimiters after a non-delimiter, so walking the set bits
+        // of those masks and the newline mask in order visits every word and
+        // line boundary. Lines split as MappedInput::Lines does.
+        template<class LineAction>
+        void ForEachLineWords(std::string_view contents, SimdLevel level, std::vector<std::string_view>& words, LineAction&& action)
+        {
+            auto data = contents.data();
+            auto size = contents.size();
+
+            auto afterDelimiter = uint64_t(1);
+            auto wordStart = size_t(0);
+            auto lineStart = size_t(0);
+            words.clear();
+
+            char padded[64];
+            for (auto base = size_t(0); base < size; base += 64)
+            {
+                auto block = data + base;
+                if (size - base < 64)
+                {
+                    // Spaces close any word still open at the end.
+                    memset(padded, ' ', sizeof(padded));
+                    memcpy(padded, block, size - base);
+                    block = padded;
+                }
+
+                uint64_t newlines;
+                auto delimiters = ClassifyBlock(block, level, newlines);
+                auto previous = (delimiters << 1) | afterDelimiter;
+                auto starts = ~delimiters & previous;
+                auto ends = delimiters & ~previous;
+                afterDelimiter = delimiters >> 63;
+
+                for (auto events = starts | ends | newlines; events != 0; events &= events - 1)
+                {
+                    auto bit = TrailingZeroBits(events);
+                    auto flag = uint64_t(1) << bit;
+                    auto position = base + bit;
+
+                    if (starts & flag)
+                    {
+                        wordStart = position;
+                    }
+
+                    if (ends & flag)
+                    {
+                        words.push_back(std::string_view(data + wordStart, position - wordStart));
+                    }
+
+                    if (newlines & flag)
+                    {
+                        action(words);
+                        words.clear();
+                        lineStart = position + 1;
+                    }
+                }
+            }
+
+            if (afterDelimiter == 0)
+            {
+                words.push_back(std::string_view(data + wordStart, size - wordStart));
+            }
+
+            if (lineStart < size)
+            {
+                action(words);
+            }
+        }
+    }
+
+    LetterSignature SignatureOf(std::string_view word)
+    {
+        auto& table = LetterTable();
+        uint64_t counts[3] = { 0, 0, 0 };
+        auto letters = size_t(0);
+
+        for (auto c : word)
+        {
+            auto byte = static_cast<unsigned char>(c);
+            counts[0] += table.increments[0][byte];
+            counts[1] += table.increments[1][byte];
+            counts[2] += table.increments[2][byte];
+            letters += table.isLetter[byte];
+        }
+
+        LetterSignature signature = { { counts[0], counts[1], counts[2] }, letters == word.size() && letters <= 31 };
+        return signature;
+    }
+
+    bool AreAnagrams(std::string_view left, std::string_view right)
+    {
+        if (left.size() != right.size())
+        {
+            return false;
+        }
+
+        int counts[256] = {};
+        for (auto c : left)
+        {
+            counts[static_cast<unsigned char>(c)]++;
+        }
+
+        for (auto c : right)
+        {
+            if (--counts[static_cast<unsigned char>(c)] < 0)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool IsValidPassphrase(std::string_view phrase, PassphraseRule rule)
+    {
+        std::string_view stackWords[StackWords];
+        std::vector<std::string_view> manyWords;
+
+        auto count = size_t(0);
+        for (auto word = NextToken(phrase, Delimiters); !word.empty(); word = NextToken(phrase, Delimiters), count++)
+        {
+            if (count < StackWords)
+            {
+                stackWords[count] = word;
+                continue;
+            }
+
+            if (manyWords.empty())
+            {
+                manyWords.assign(stackWords, stackWords + count);
+            }
+
+            manyWords.push_back(word);
+        }
+
+        repeatFinder finder;
+        return !finder.HasRepeat(count <= StackWords ? stackWords : manyWords.data(), count, rule);
+    }
+
+    PassphraseCounts CountValidPassphrases(std::string_view contents, ThreadPool& pool, SimdLevel level)
+    {
+        auto chunks = SplitChunks(contents, std::max(contents.size() / ChunkBytes, size_t(1)));
+        std::vector<PassphraseCounts> partials(chunks.size(), PassphraseCounts{ 0, 0, 0 });
+
+        pool.Run(
+            chunks.size(),
+            [&chunks, &partials, level](size_t index)
+            {
+                repeatFinder finder;
+                std::vector<std::string_view> words;
+                auto& counts = partials[index];
+
+                ForEachLineWords(
+                    chunks[index],
+                    level,
+                    words,
+                    [&finder, &counts](const std::vector<std::string_view>& line)
+                    {
+                        // A repeated word is also a repeated anagram, so the
+                        // plain check is only needed when the anagram one fails.
+                        counts.lines++;
+                        if (!finder.HasRepeat(line.data(), line.size(), PassphraseRule::NoAnagrams))
+                        {
+                            counts.noDuplicates++;
+                            counts.noAnagrams++;
+                        }
+                        else if (!finder.HasRepeat(line.data(), line.size(), PassphraseRule::NoDuplicates))
+                        {
+                            counts.noDuplicates++;
+                        }
+                    });
+            });
+
+        PassphraseCounts total = { 0, 0, 0 };
+        for (auto& partial : partials)
+        {
+            total.lines += partial.lines;
+            total.noDuplicates += partial.noDuplicates;
+            total.noAnagrams += partial.noAnagrams;
+        }
+
+        return total;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Simd.h"
+#include "Parallel.h"
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+namespace AdventOfCode2017
+{
+    enum class PassphraseRule
+    {
+        // Day 4 part 1: no word may appear twice.
+        NoDuplicates,
+        // Day 4 part 2: no word may be an anagram of another.
+        NoAnagrams
+    };
+
+    // Packed letter counts of a word, 5 bits for each of 'a' to 'z': a to l
+    // in counts[0], m to x in counts[1], y and z in counts[2]. Two words are
+    // anagrams exactly when their signatures are equal, as long as both are
+    // exact: lowercase letters only and no more than 31 of them.
+    struct LetterSignature
+    {
+        uint64_t counts[3];
+        bool exact;
+    };
+
+    LetterSignature SignatureOf(std::string_view word);
+
+    // Whether two words hold the same bytes in any order.
+    bool AreAnagrams(std::string_view left, std::string_view right);
+
+    // Splits the phrase into words on spaces and line breaks, and checks them
+    // against a small open-addressing table of 64-bit keys on the stack: a
+    // hash of the word, or of its signature for anagrams. Only phrases with
+    // more words than the stack table holds allocate.
+    bool IsValidPassphrase(std::string_view phrase, PassphraseRule rule);
+
+    struct PassphraseCounts
+    {
+        size_t lines;
+        size_t noDuplicates;
+        size_t noAnagrams;
+    };
+
+    // Both Day 4 answers for a whole file, such as MappedInput::Contents(),
+    // with each line tokenized once for both rules. Word and line boundaries
+    // come from vector compares over 64-byte blocks, and blocks of lines are
+    // spread over the pool. Lines split as MappedInput::Lines does, and an
+    // empty line counts as a valid passphrase.
+    PassphraseCounts CountValidPassphrases(std::string_view contents, ThreadPool& pool = ThreadPool::Default(), SimdLevel level = DetectSimdLevel());
+}
\ No newline at end of file
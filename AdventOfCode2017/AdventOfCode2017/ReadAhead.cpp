@@ -0,0 +1,199 @@
+#include "stdafx.h"
+#include "ReadAhead.h"
+#include <algorithm>
+#include <cstring>
+
+namespace AdventOfCode2017
+{
+    namespace
+    {
+        const size_t NoBuffer = static_cast<size_t>(-1);
+
+        std::string_view TrimLine(std::string_view line)
+        {
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.remove_suffix(1);
+            }
+
+            return line;
+        }
+    }
+
+    ReadAheadInput::ReadAheadInput(const std::string& fileName, size_t blockSize, size_t queueDepth) :
+        input(fileName, std::ios::in | std::ios::binary),
+        heldBuffer(NoBuffer),
+        finished(false),
+        failed(false),
+        stopping(false)
+    {
+        if (input.fail())
+        {
+            throw 1;
+        }
+
+        // One buffer more than the queue holds, for the block the consumer
+        // is working on.
+        auto count = std::max(queueDepth, size_t(1)) + 1;
+        buffers.resize(count, std::vector<char>(std::max(blockSize, size_t(1))));
+
+        for (auto ii = count; ii > 0; ii--)
+        {
+            freeBuffers.push_back(ii - 1);
+        }
+
+        reader = std::thread([this]() { ReadLoop(); });
+    }
+
+    ReadAheadInput::~ReadAheadInput()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+
+        changed.notify_all();
+        reader.join();
+    }
+
+    void ReadAheadInput::ReadLoop()
+    {
+        while (true)
+        {
+            size_t index;
+
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                changed.wait(guard, [this]() { return stopping || !freeBuffers.empty(); });
+
+                if (stopping)
+                {
+                    return;
+                }
+
+                index = freeBuffers.back();
+                freeBuffers.pop_back();
+            }
+
+            // The file is only touched by this thread, so the read itself
+            // happens outside the lock.
+            auto& buffer = buffers[index];
+            input.read(buffer.data(), buffer.size());
+            auto count = static_cast<size_t>(input.gcount());
+            auto done = count < buffer.size();
+
+            {
+                std::lock_guard<std::mutex> guard(lock);
+
+                if (count > 0)
+                {
+                    filledBlocks.push_back(filledBlock{ index, count });
+                }
+                else
+                {
+                    freeBuffers.push_back(index);
+                }
+
+                finished = done;
+                failed = input.bad();
+            }
+
+            changed.notify_all();
+
+            if (done)
+            {
+                return;
+            }
+        }
+    }
+
+    std::string_view ReadAheadInput::NextBlock()
+    {
+        std::unique_lock<std::mutex> guard(lock);
+
+        if (heldBuffer != NoBuffer)
+        {
+            freeBuffers.push_back(heldBuffer);
+            heldBuffer = NoBuffer;
+            changed.notify_all();
+        }
+
+        changed.wait(guard, [this]() { return finished || !filledBlocks.empty(); });
+
+        if (filledBlocks.empty())
+        {
+            if (failed)
+            {
+                throw 1;
+            }
+
+            return std::string_view();
+        }
+
+        auto block = filledBlocks.front();
+        filledBlocks.pop_front();
+        heldBuffer = block.buffer;
+
+        return std::string_view(buffers[block.buffer].data(), block.size);
+    }
+
+    AsyncLineReader::AsyncLineReader(const std::string& fileName, size_t blockSize, size_t queueDepth) :
+        input(fileName, blockSize, queueDepth),
+        position(0),
+        carryReturned(false)
+    {
+    }
+
+    bool AsyncLineReader::Next(std::string_view& line)
+    {
+        if (carryReturned)
+        {
+            carry.clear();
+            carryReturned = false;
+        }
+
+        while (true)
+        {
+            auto begin = block.data() + position;
+            auto available = block.size() - position;
+            auto newline = static_cast<const char*>(available > 0 ? memchr(begin, '\n', available) : nullptr);
+
+            if (newline != nullptr)
+            {
+                auto piece = std::string_view(begin, newline - begin);
+                position += piece.size() + 1;
+
+                if (carry.empty())
+                {
+                    line = TrimLine(piece);
+                }
+                else
+                {
+                    carry.append(piece.data(), piece.size());
+                    line = TrimLine(carry);
+                    carryReturned = true;
+                }
+
+                return true;
+            }
+
+            // The rest of this block is the start of a line that continues in
+            // the next one.
+            carry.append(begin, available);
+            block = input.NextBlock();
+            position = 0;
+
+            if (block.empty())
+            {
+                if (carry.empty())
+                {
+                    return false;
+                }
+
+                line = TrimLine(carry);
+                carryReturned = true;
+                return true;
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Utilities.h"
+#include <vector>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+
+namespace AdventOfCode2017
+{
+    // Reads a file on a background thread in fixed-size blocks, so the caller
+    // can work on one block while the following ones are being read. At most
+    // queueDepth blocks wait in the queue; the reader thread blocks when the
+    // consumer falls behind, so memory stays at (queueDepth + 1) blocks.
+    class ReadAheadInput
+    {
+    public:
+        static const size_t DefaultBlockSize = 256 * 1024;
+        static const size_t DefaultQueueDepth = 2;
+
+        explicit ReadAheadInput(const std::string& fileName, size_t blockSize = DefaultBlockSize, size_t queueDepth = DefaultQueueDepth);
+        ~ReadAheadInput();
+
+        ReadAheadInput(const ReadAheadInput&) = delete;
+        ReadAheadInput& operator=(const ReadAheadInput&) = delete;
+
+        // Returns the next block of the file, or an empty view at the end.
+        // The view is valid until the next call.
+        std::string_view NextBlock();
+
+    private:
+        struct filledBlock
+        {
+            size_t buffer;
+            size_t size;
+        };
+
+        void ReadLoop();
+
+        std::ifstream input;
+        std::vector<std::vector<char>> buffers;
+        std::vector<size_t> freeBuffers;
+        std::deque<filledBlock> filledBlocks;
+        size_t heldBuffer;
+        bool finished;
+        bool failed;
+        bool stopping;
+        std::mutex lock;
+        std::condition_variable changed;
+        std::thread reader;
+    };
+
+    // Lines of a file read through ReadAheadInput, split the same way as
+    // MappedInput::Lines. Each line view is invalidated by the next call to
+    // Next (or iterator increment).
+    class AsyncLineReader
+    {
+    public:
+        using iterator = LineIterator<AsyncLineReader>;
+
+        explicit AsyncLineReader(const std::string& fileName, size_t blockSize = ReadAheadInput::DefaultBlockSize, size_t queueDepth = ReadAheadInput::DefaultQueueDepth);
+
+        bool Next(std::string_view& line);
+
+        iterator begin() { return iterator(this); }
+
+        iterator end() { return iterator(); }
+
+    private:
+        ReadAheadInput input;
+        std::string_view block;
+        size_t position;
+
+        // Start of a line that ran off the end of the previous block.
+        std::string carry;
+        bool carryReturned;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#include "stdafx.h"
+#include "Simd.h"
+#include <intrin.h>
+
+namespace AdventOfCode2017
+{
+    namespace
+    {
+        SimdLevel QuerySimdLevel()
+        {
+            int info[4];
+
+            __cpuid(info, 0);
+            auto maxLeaf = info[0];
+
+            __cpuid(info, 1);
+            auto ssse3 = (info[2] & (1 << 9)) != 0;
+            auto sse41 = (info[2] & (1 << 19)) != 0;
+            auto osxsave = (info[2] & (1 << 27)) != 0;
+            auto avx = (info[2] & (1 << 28)) != 0;
+
+            if (!ssse3 || !sse41)
+            {
+                return SimdLevel::Scalar;
+            }
+
+            // AVX state must also be enabled by the OS (XMM and YMM in XCR0).
+            if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6)
+            {
+                __cpuidex(info, 7, 0);
+                if ((info[1] & (1 << 5)) != 0)
+                {
+                    return SimdLevel::Avx2;
+                }
+            }
+
+            return SimdLevel::Sse41;
+        }
+    }
+
+    SimdLevel DetectSimdLevel()
+    {
+        static const SimdLevel level = QuerySimdLevel();
+        return level;
+    }
+}
\ No newline at end of file
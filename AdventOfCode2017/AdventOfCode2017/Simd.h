@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <intrin.h>
+
+namespace AdventOfCode2017
+{
+    // Instruction set tiers that the vectorized kernels are written for, in
+    // increasing order. Every kernel has a scalar fallback.
+    enum class SimdLevel
+    {
+        Scalar = 0,
+        Sse41 = 1,
+        Avx2 = 2,
+    };
+
+    // Highest level supported by both the CPU and the OS, detected once.
+    SimdLevel DetectSimdLevel();
+
+    // Index of the lowest set bit of a non-zero value, for walking the bit
+    // masks the vector compares produce.
+    inline unsigned TrailingZeroBits(uint64_t value)
+    {
+        unsigned long index;
+#if defined(_M_X64) || defined(_M_ARM64)
+        _BitScanForward64(&index, value);
+#else
+        if (!_BitScanForward(&index, static_cast<unsigned long>(value)))
+        {
+            _BitScanForward(&index, static_cast<unsigned long>(value >> 32));
+            index += 32;
+        }
+#endif
+        return index;
+    }
+}
\ No newline at end of file
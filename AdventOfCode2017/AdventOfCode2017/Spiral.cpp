@@ -0,0 +1,220 @@
+#include "stdafx.h"
+#include "Spiral.h"
+#include <algorithm>
+#include <cmath>
+#include <intrin.h>
+
+namespace AdventOfCode2017
+{
+    namespace
+    {
+        // Floor of the square root, corrected after the floating point
+        // estimate so it is exact across the whole 64-bit range used here.
+        uint64_t SquareRoot(uint64_t value)
+        {
+            auto root = static_cast<uint64_t>(std::sqrt(static_cast<double>(value)));
+            root -= root * root > value ? 1 : 0;
+            root += (root + 1) * (root + 1) <= value ? 1 : 0;
+            return root;
+        }
+
+        int64_t Select(bool condition, int64_t ifTrue, int64_t ifFalse)
+        {
+            return condition ? ifTrue : ifFalse;
+        }
+
+        void Coordinates(uint64_t index, int64_t& x, int64_t& y)
+        {
+            // Index n lies on ring k = ceil((sqrt(n) - 1) / 2), which is
+            // (isqrt(n - 1) + 1) / 2 in integers, at offset t from the
+            // square after (2k - 1)^2. The ring's four sides are 2k long.
+            auto ring = static_cast<int64_t>((SquareRoot(index - 1) + 1) / 2);
+            auto inner = 2 * ring - 1;
+            auto offset = static_cast<int64_t>(index - 1) - inner * inner;
+            auto side = 2 * ring;
+
+            // Right side going up, top going left, left going down, bottom
+            // going right. The origin has ring 0 and offset -1, so it takes
+            // the first branch, which gives (0, 0).
+            x = Select(offset < side, ring,
+                Select(offset < 2 * side, ring - 1 - (offset - side),
+                Select(offset < 3 * side, -ring, -ring + 1 + (offset - 3 * side))));
+            y = Select(offset < side, -ring + 1 + offset,
+                Select(offset < 2 * side, ring,
+                Select(offset < 3 * side, ring - 1 - (offset - 2 * side), -ring)));
+        }
+
+        uint64_t Index(int64_t x, int64_t y)
+        {
+            auto ring = std::max(x < 0 ? -x : x, y < 0 ? -y : y);
+            auto inner = 2 * ring - 1;
+            auto side = 2 * ring;
+
+            auto offset =
+                Select(x == ring && y > -ring, y + ring - 1,
+                Select(y == ring, side + (ring - 1 - x),
+                Select(x == -ring, 2 * side + (ring - 1 - y), 3 * side + (x + ring - 1))));
+
+            return Select(ring == 0, 1, inner * inner + 1 + offset);
+        }
+
+        __m256i Multiply(__m256i left, __m256i right)
+        {
+            // Both operands stay below 2^32 in the spiral's range, so the
+            // low halves are enough for the full 64-bit product.
+            return _mm256_mul_epu32(left, right);
+        }
+
+        __m256i Blend(__m256i mask, __m256i ifTrue, __m256i ifFalse)
+        {
+            return _mm256_blendv_epi8(ifFalse, ifTrue, mask);
+        }
+
+        void CoordinatesAvx2(const uint64_t* indices, size_t count, int64_t* xs, int64_t* ys)
+        {
+            const auto one = _mm256_set1_epi64x(1);
+            const auto exponent = _mm256_set1_epi64x(0x4330000000000000);
+            const auto highExponent = _mm256_set1_epi64x(0x4530000000000000);
+            const auto lowMask = _mm256_set1_epi64x(0xffffffff);
+            const auto mantissaMask = _mm256_set1_epi64x(0x000fffffffffffff);
+            const auto twoTo52 = _mm256_castsi256_pd(exponent);
+            const auto twoTo84PlusTwoTo52 = _mm256_castsi256_pd(_mm256_set1_epi64x(0x4530000000100000));
+
+            auto ii = size_t(0);
+            for (; ii + 4 <= count; ii += 4)
+            {
+                auto value = _mm256_sub_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + ii)), one);
+
+                // There is no 64-bit integer to double conversion before
+                // AVX-512, so each half is placed in a double's mantissa.
+                auto low = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(value, lowMask), exponent));
+                auto high = _mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(value, 32), highExponent));
+                auto estimate = _mm256_add_pd(_mm256_sub_pd(high, twoTo84PlusTwoTo52), low);
+
+                auto rounded = _mm256_add_pd(_mm256_floor_pd(_mm256_sqrt_pd(estimate)), twoTo52);
+                auto root = _mm256_and_si256(_mm256_castpd_si256(rounded), mantissaMask);
+
+                root = _mm256_add_epi64(root, _mm256_cmpgt_epi64(Multiply(root, root), value));
+                auto next = _mm256_add_epi64(root, one);
+                root = _mm256_add_epi64(next, _mm256_cmpgt_epi64(Multiply(next, next), value));
+
+                auto ring = _mm256_srli_epi64(_mm256_add_epi64(root, one), 1);
+                auto ringLess = _mm256_sub_epi64(ring, one);
+                auto inner = _mm256_add_epi64(ring, ringLess);
+                auto offset = _mm256_sub_epi64(value, Multiply(inner, inner));
+                auto side = _mm256_add_epi64(ring, ring);
+                auto negativeRing = _mm256_sub_epi64(_mm256_setzero_si256(), ring);
+
+                auto first = _mm256_cmpgt_epi64(side, offset);
+                auto second = _mm256_cmpgt_epi64(_mm256_add_epi64(side, side), offset);
+                auto third = _mm256_cmpgt_epi64(_mm256_add_epi64(_mm256_add_epi64(side, side), side), offset);
+
+                auto x = Blend(first, ring,
+                    Blend(second, _mm256_sub_epi64(_mm256_add_epi64(ringLess, side), offset),
+                    Blend(third, negativeRing,
+                        _mm256_sub_epi64(_mm256_add_epi64(offset, _mm256_sub_epi64(one, ring)), _mm256_add_epi64(_mm256_add_epi64(side, side), side)))));
+                auto y = Blend(first, _mm256_add_epi64(_mm256_sub_epi64(one, ring), offset),
+                    Blend(second, ring,
+                    Blend(third, _mm256_sub_epi64(_mm256_add_epi64(ringLess, _mm256_add_epi64(side, side)), offset),
+                        negativeRing)));
+
+                // Unlike the scalar version the origin needs masking here:
+                // Multiply squares the low half of inner = -1 as 2^32 - 1.
+                auto origin = _mm256_cmpeq_epi64(ring, _mm256_setzero_si256());
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(xs + ii), _mm256_andnot_si256(origin, x));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(ys + ii), _mm256_andnot_si256(origin, y));
+            }
+
+            for (; ii < count; ii++)
+            {
+                Coordinates(indices[ii], xs[ii], ys[ii]);
+            }
+        }
+
+        __m256i Absolute(__m256i value)
+        {
+            auto sign = _mm256_cmpgt_epi64(_mm256_setzero_si256(), value);
+            return _mm256_sub_epi64(_mm256_xor_si256(value, sign), sign);
+        }
+
+        void IndicesAvx2(const int64_t* xs, const int64_t* ys, size_t count, uint64_t* indices)
+        {
+            const auto one = _mm256_set1_epi64x(1);
+
+            auto ii = size_t(0);
+            for (; ii + 4 <= count; ii += 4)
+            {
+                auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(xs + ii));
+                auto y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ys + ii));
+
+                auto absoluteX = Absolute(x);
+                auto absoluteY = Absolute(y);
+                auto ring = Blend(_mm256_cmpgt_epi64(absoluteY, absoluteX), absoluteY, absoluteX);
+                auto negativeRing = _mm256_sub_epi64(_mm256_setzero_si256(), ring);
+                auto inner = _mm256_sub_epi64(_mm256_add_epi64(ring, ring), one);
+                auto side = _mm256_add_epi64(ring, ring);
+
+                auto right = _mm256_and_si256(_mm256_cmpeq_epi64(x, ring), _mm256_cmpgt_epi64(y, negativeRing));
+                auto top = _mm256_cmpeq_epi64(y, ring);
+                auto left = _mm256_cmpeq_epi64(x, negativeRing);
+
+                // inner = ring - 1 + ring, so each side's offset is a sum
+                // of inner, whole sides, and the coordinate along it.
+                auto offset = Blend(right, _mm256_add_epi64(_mm256_sub_epi64(y, one), ring),
+                    Blend(top, _mm256_sub_epi64(_mm256_add_epi64(inner, side), _mm256_add_epi64(x, ring)),
+                    Blend(left, _mm256_sub_epi64(_mm256_add_epi64(inner, _mm256_add_epi64(side, side)), _mm256_add_epi64(y, ring)),
+                        _mm256_add_epi64(_mm256_add_epi64(_mm256_add_epi64(side, side), side), _mm256_add_epi64(_mm256_sub_epi64(x, one), ring)))));
+
+                auto index = _mm256_add_epi64(_mm256_add_epi64(Multiply(inner, inner), one), offset);
+                auto origin = _mm256_cmpeq_epi64(ring, _mm256_setzero_si256());
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(indices + ii), Blend(origin, one, index));
+            }
+
+            for (; ii < count; ii++)
+            {
+                indices[ii] = Index(xs[ii], ys[ii]);
+            }
+        }
+    }
+
+    std::pair<int64_t, int64_t> SpiralCoordinates(uint64_t index)
+    {
+        int64_t x;
+        int64_t y;
+        Coordinates(index, x, y);
+        return std::make_pair(x, y);
+    }
+
+    uint64_t SpiralIndex(int64_t x, int64_t y)
+    {
+        return Index(x, y);
+    }
+
+    void SpiralCoordinates(const uint64_t* indices, size_t count, int64_t* xs, int64_t* ys, SimdLevel level)
+    {
+        if (level == SimdLevel::Avx2)
+        {
+            CoordinatesAvx2(indices, count, xs, ys);
+            return;
+        }
+
+        for (auto ii = size_t(0); ii < count; ii++)
+        {
+            Coordinates(indices[ii], xs[ii], ys[ii]);
+        }
+    }
+
+    void SpiralIndices(const int64_t* xs, const int64_t* ys, size_t count, uint64_t* indices, SimdLevel level)
+    {
+        if (level == SimdLevel::Avx2)
+        {
+            IndicesAvx2(xs, ys, count, indices);
+            return;
+        }
+
+        for (auto ii = size_t(0); ii < count; ii++)
+        {
+            indices[ii] = Index(xs[ii], ys[ii]);
+        }
+    }
+}
\ No newline at end of file
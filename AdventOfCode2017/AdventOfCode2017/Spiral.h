@@ -0,0 +1,105 @@
+#pragma once
+
+#include "Simd.h"
+#include <algorithm>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+namespace AdventOfCode2017
+{
+    // Geometry of the Day 3 spiral: square 1 at the origin, square 2 at
+    // (1, 0), then counter-clockwise with y pointing up. Ring k holds the
+    // squares ((2k - 1)^2, (2k + 1)^2], and ends at (k, -k). Indices run
+    // from 1 to 2^62, which keeps both coordinates within +/-2^30.
+
+    // Coordinates of a square in O(1).
+    std::pair<int64_t, int64_t> SpiralCoordinates(uint64_t index);
+
+    // Square at the given coordinates; the inverse of SpiralCoordinates.
+    uint64_t SpiralIndex(int64_t x, int64_t y);
+
+    // Batched forms that map whole arrays, four entries at a time with AVX2.
+    void SpiralCoordinates(const uint64_t* indices, size_t count, int64_t* xs, int64_t* ys, SimdLevel level = DetectSimdLevel());
+    void SpiralIndices(const int64_t* xs, const int64_t* ys, size_t count, uint64_t* indices, SimdLevel level = DetectSimdLevel());
+
+    // Fills the spiral square by square, giving each square the fold of its
+    // already filled neighbours: update(update(Value(), first), second) and
+    // so on. Only the ring being filled and the one inside it are kept, each
+    // as an array in spiral order, so every neighbour is a fixed offset into
+    // one of them and memory grows with the ring rather than the square.
+    template<class Value, class Update>
+    class SpiralRings
+    {
+    public:
+        explicit SpiralRings(Value origin, Update update = Update())
+            : previous(1, origin), current(8), ring(1), position(0), side(0), along(0), update(update)
+        {
+        }
+
+        // The value of the next square, starting with square 2.
+        Value Next()
+        {
+            if (position == current.size())
+            {
+                previous.swap(current);
+                ring++;
+                current.resize(8 * ring);
+                position = 0;
+                side = 0;
+                along = 0;
+            }
+
+            auto sideLength = 2 * ring;
+            auto total = Value();
+
+            // Square j of a side touches squares j - 2 to j of the same side
+            // of the inner ring, where square -1 is the corner before it (the
+            // inner ring's last square, for the first side). Ring 1 sees the
+            // origin once, through that corner.
+            auto innerLength = static_cast<ptrdiff_t>(sideLength) - 2;
+            auto base = innerLength * static_cast<ptrdiff_t>(side);
+            auto first = std::max(static_cast<ptrdiff_t>(along) - 2, ptrdiff_t(-1));
+            auto last = std::min(static_cast<ptrdiff_t>(along), innerLength - 1);
+            for (auto ii = first; ii <= last; ii++)
+            {
+                auto inner = base + ii;
+                total = update(total, previous[inner < 0 ? previous.size() - 1 : static_cast<size_t>(inner)]);
+            }
+
+            // In this ring: the square before, the one before the corner when
+            // starting a side, and the ring's first square for the last two.
+            if (position > 0)
+            {
+                total = update(total, current[position - 1]);
+            }
+            if (along == 0 && side > 0)
+            {
+                total = update(total, current[position - 2]);
+            }
+            if (side == 3 && along + 2 >= sideLength)
+            {
+                total = update(total, current[0]);
+            }
+
+            current[position++] = total;
+            if (++along == sideLength)
+            {
+                along = 0;
+                side++;
+            }
+
+            return total;
+        }
+
+    private:
+        std::vector<Value> previous;
+        std::vector<Value> current;
+        size_t ring;
+        size_t position;
+        size_t side;
+        size_t along;
+        Update update;
+    };
+}
\ No newline at end of file
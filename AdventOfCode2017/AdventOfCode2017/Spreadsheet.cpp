@@ -0,0 +1,240 @@
+#include "stdafx.h"
+#include "Spreadsheet.h"
+#include "DivisiblePairs.h"
+#include "ParseInt.h"
+#include "Utilities.h"
+#include <algorithm>
+#include <functional>
+#include <intrin.h>
+
+namespace AdventOfCode2017
+{
+    namespace
+    {
+        const size_t MinimumChunkValues = 64 * 1024;
+
+        std::pair<int32_t, int32_t> RowRangeScalar(const int32_t* row, size_t count)
+        {
+            auto minmax = std::minmax_element(row, row + count);
+            return std::make_pair(*minmax.first, *minmax.second);
+        }
+
+        std::pair<int32_t, int32_t> Fold(__m128i low, __m128i high)
+        {
+            low = _mm_min_epi32(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(1, 0, 3, 2)));
+            low = _mm_min_epi32(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(2, 3, 0, 1)));
+            high = _mm_max_epi32(high, _mm_shuffle_epi32(high, _MM_SHUFFLE(1, 0, 3, 2)));
+            high = _mm_max_epi32(high, _mm_shuffle_epi32(high, _MM_SHUFFLE(2, 3, 0, 1)));
+
+            return std::make_pair(_mm_cvtsi128_si32(low), _mm_cvtsi128_si32(high));
+        }
+
+        std::pair<int32_t, int32_t> Merge(std::pair<int32_t, int32_t> range, const int32_t* row, size_t count)
+        {
+            for (auto ii = size_t(0); ii < count; ii++)
+            {
+                range.first = std::min(range.first, row[ii]);
+                range.second = std::max(range.second, row[ii]);
+            }
+
+            return range;
+        }
+
+        std::pair<int32_t, int32_t> RowRangeSse(const int32_t* row, size_t count)
+        {
+            if (count < 4)
+            {
+                return RowRangeScalar(row, count);
+            }
+
+            auto low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row));
+            auto high = low;
+
+            auto ii = size_t(4);
+            for (; ii + 4 <= count; ii += 4)
+            {
+                auto values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + ii));
+                low = _mm_min_epi32(low, values);
+                high = _mm_max_epi32(high, values);
+            }
+
+            return Merge(Fold(low, high), row + ii, count - ii);
+        }
+
+        std::pair<int32_t, int32_t> RowRangeAvx2(const int32_t* row, size_t count)
+        {
+            if (count < 8)
+            {
+                return RowRangeSse(row, count);
+            }
+
+            auto low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row));
+            auto high = low;
+
+            auto ii = size_t(8);
+            for (; ii + 8 <= count; ii += 8)
+            {
+                auto values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + ii));
+                low = _mm256_min_epi32(low, values);
+                high = _mm256_max_epi32(high, values);
+            }
+
+            auto range = Fold(
+                _mm_min_epi32(_mm256_castsi256_si128(low), _mm256_extracti128_si256(low, 1)),
+                _mm_max_epi32(_mm256_castsi256_si128(high), _mm256_extracti128_si256(high, 1)));
+
+            return Merge(range, row + ii, count - ii);
+        }
+
+        // Sums rangeValue over all rows, splitting the rows into chunks of
+        // about the same number of values so wide and narrow rows balance.
+        // rangeValue(first, last) gives the total for rows [first, last), so
+        // it can set up per-chunk state once rather than once a row.
+        int64_t SumRows(const Spreadsheet& sheet, ThreadPool& pool, const std::function<int64_t(size_t, size_t)>& rangeValue)
+        {
+            auto chunkCount = std::min(pool.Size() * 4, sheet.ValueCount() / MinimumChunkValues);
+
+            if (chunkCount <= 1)
+            {
+                return rangeValue(0, sheet.RowCount());
+            }
+
+            std::vector<size_t> boundaries(chunkCount + 1, sheet.RowCount());
+            boundaries[0] = 0;
+            for (auto chunk = size_t(1); chunk < chunkCount; chunk++)
+            {
+                boundaries[chunk] = std::max(boundaries[chunk - 1], sheet.RowContaining(sheet.ValueCount() * chunk / chunkCount));
+            }
+
+            std::vector<int64_t> partials(chunkCount, 0);
+
+            pool.Run(
+                chunkCount,
+                [&](size_t chunk)
+                {
+                    partials[chunk] = rangeValue(boundaries[chunk], boundaries[chunk + 1]);
+                });
+
+            auto total = int64_t(0);
+            for (auto partial : partials)
+            {
+                total += partial;
+            }
+
+            return total;
+        }
+    }
+
+    Spreadsheet::Spreadsheet(const std::vector<std::vector<int32_t>>& rows) : offsets(1, 0)
+    {
+        auto total = size_t(0);
+        for (auto& row : rows)
+        {
+            total += row.size();
+        }
+
+        values.reserve(total);
+        offsets.reserve(rows.size() + 1);
+
+        for (auto& row : rows)
+        {
+            AddRow(row.data(), row.size());
+        }
+    }
+
+    void Spreadsheet::AddRow(const int32_t* row, size_t count)
+    {
+        values.insert(values.end(), row, row + count);
+        EndRow();
+    }
+
+    size_t Spreadsheet::RowContaining(size_t valueIndex) const
+    {
+        return std::upper_bound(offsets.begin(), offsets.end(), valueIndex) - offsets.begin() - 1;
+    }
+
+    std::pair<int32_t, int32_t> RowRange(const int32_t* row, size_t count, SimdLevel level)
+    {
+        if (count == 0)
+        {
+            return std::make_pair(0, 0);
+        }
+
+        switch (level)
+        {
+        case SimdLevel::Avx2:
+            return RowRangeAvx2(row, count);
+        case SimdLevel::Sse41:
+            return RowRangeSse(row, count);
+        default:
+            return RowRangeScalar(row, count);
+        }
+    }
+
+    int64_t SpreadsheetChecksum(const Spreadsheet& sheet, ThreadPool& pool, SimdLevel level)
+    {
+        return SumRows(
+            sheet,
+            pool,
+            [&sheet, level](size_t first, size_t last)
+            {
+                auto total = int64_t(0);
+                for (auto row = first; row < last; row++)
+                {
+                    auto range = RowRange(sheet.Row(row), sheet.RowSize(row), level);
+                    total += int64_t(range.second) - range.first;
+                }
+
+                return total;
+            });
+    }
+
+    int64_t SpreadsheetSumDivisible(const Spreadsheet& sheet, ThreadPool& pool)
+    {
+        return SumRows(
+            sheet,
+            pool,
+            [&sheet](size_t first, size_t last)
+            {
+                // One finder for the chunk, so its buffers serve every row.
+                DivisiblePairFinder finder;
+                auto total = int64_t(0);
+                for (auto row = first; row < last; row++)
+                {
+                    total += finder.Quotient(sheet.Row(row), sheet.RowSize(row));
+                }
+
+                return total;
+            });
+    }
+
+    SpreadsheetTotals StreamSpreadsheet(const std::string& fileName, SimdLevel level)
+    {
+        SpreadsheetTotals totals = { 0, 0, 0 };
+
+        LineReader lines(fileName);
+        std::vector<int32_t> row;
+        DivisiblePairFinder finder;
+
+        for (auto iter = lines.begin(); iter != lines.end(); ++iter)
+        {
+            row.clear();
+            if (ParseIntList(*iter, row).error != ParseError::None)
+            {
+                throw 1;
+            }
+
+            if (row.empty())
+            {
+                continue;
+            }
+
+            auto range = RowRange(row.data(), row.size(), level);
+            totals.rows++;
+            totals.checksum += int64_t(range.second) - range.first;
+            totals.divisible += finder.Quotient(row.data(), row.size());
+        }
+
+        return totals;
+    }
+}
\ No newline at end of file
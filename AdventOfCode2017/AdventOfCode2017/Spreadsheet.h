@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Simd.h"
+#include "Parallel.h"
+#include <vector>
+#include <string>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+namespace AdventOfCode2017
+{
+    // Rows of integers stored end to end in one buffer, with the start of
+    // each row kept in a separate offset table.
+    class Spreadsheet
+    {
+    public:
+        Spreadsheet() : offsets(1, 0) { }
+
+        explicit Spreadsheet(const std::vector<std::vector<int32_t>>& rows);
+
+        void AddRow(const int32_t* row, size_t count);
+
+        // Appends the values of a row one at a time; EndRow closes it.
+        void AddValue(int32_t value) { values.push_back(value); }
+
+        void EndRow() { offsets.push_back(values.size()); }
+
+        size_t RowCount() const { return offsets.size() - 1; }
+
+        size_t ValueCount() const { return values.size(); }
+
+        const int32_t* Row(size_t row) const { return values.data() + offsets[row]; }
+
+        size_t RowSize(size_t row) const { return offsets[row + 1] - offsets[row]; }
+
+        // First row whose values extend past the given value index.
+        size_t RowContaining(size_t valueIndex) const;
+
+    private:
+        std::vector<int32_t> values;
+        std::vector<size_t> offsets;
+    };
+
+    // Smallest and largest value of a row; an empty row gives (0, 0).
+    std::pair<int32_t, int32_t> RowRange(const int32_t* row, size_t count, SimdLevel level = DetectSimdLevel());
+
+    // Day 2 part 1: the sum over all rows of largest minus smallest value.
+    int64_t SpreadsheetChecksum(const Spreadsheet& sheet, ThreadPool& pool = ThreadPool::Default(), SimdLevel level = DetectSimdLevel());
+
+    // Day 2 part 2: the sum over all rows of DivisibleQuotient.
+    int64_t SpreadsheetSumDivisible(const Spreadsheet& sheet, ThreadPool& pool = ThreadPool::Default());
+
+    struct SpreadsheetTotals
+    {
+        size_t rows;
+        int64_t checksum;
+        int64_t divisible;
+    };
+
+    // Both Day 2 answers for a tab-separated file, computed while it is read
+    // in one pass. Only the current row is held, in a buffer reused from row
+    // to row, so memory does not grow with the number of rows. Blank lines
+    // are skipped.
+    SpreadsheetTotals StreamSpreadsheet(const std::string& fileName, SimdLevel level = DetectSimdLevel());
+}
\ No newline at end of file
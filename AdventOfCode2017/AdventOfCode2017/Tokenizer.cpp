@@ -0,0 +1,162 @@
+#include "stdafx.h"
+#include "Tokenizer.h"
+#include <algorithm>
+#include <cstring>
+#include <intrin.h>
+
+namespace AdventOfCode2017
+{
+    Tokenizer::Tokenizer(std::string_view input, std::string_view delimiters, SimdLevel simdLevel) :
+        text(input),
+        level(simdLevel),
+        lowNibbles(),
+        highNibbles(),
+        isDelimiter(),
+        base(0),
+        delimiterBits(0),
+        position(0)
+    {
+        // Each distinct high nibble gets its own bit; a low nibble's entry
+        // holds the bits of the high nibbles it forms a delimiter with.
+        auto nextBit = 0;
+        for (auto c : delimiters)
+        {
+            auto byte = static_cast<unsigned char>(c);
+            isDelimiter[byte] = true;
+
+            auto& high = highNibbles[byte >> 4];
+            if (high == 0)
+            {
+                if (nextBit == 8)
+                {
+                    level = SimdLevel::Scalar;
+                    continue;
+                }
+
+                high = static_cast<uint8_t>(1 << nextBit++);
+            }
+
+            lowNibbles[byte & 15] |= high;
+        }
+
+        if (!text.empty())
+        {
+            LoadBlock(0);
+        }
+    }
+
+    uint64_t Tokenizer::Classify(const char* block) const
+    {
+        switch (level)
+        {
+        case SimdLevel::Avx2:
+        {
+            auto low = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(lowNibbles)));
+            auto high = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(highNibbles)));
+            auto nibble = _mm256_set1_epi8(15);
+
+            auto others = uint64_t(0);
+            for (auto half = 0; half < 2; half++)
+            {
+                auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32 * half));
+                auto lowMatch = _mm256_shuffle_epi8(low, _mm256_and_si256(bytes, nibble));
+                auto highMatch = _mm256_shuffle_epi8(high, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibble));
+                auto other = _mm256_cmpeq_epi8(_mm256_and_si256(lowMatch, highMatch), _mm256_setzero_si256());
+                others |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(other))) << (32 * half);
+            }
+            return ~others;
+        }
+        case SimdLevel::Sse41:
+        {
+            auto low = _mm_load_si128(reinterpret_cast<const __m128i*>(lowNibbles));
+            auto high = _mm_load_si128(reinterpret_cast<const __m128i*>(highNibbles));
+            auto nibble = _mm_set1_epi8(15);
+
+            auto others = uint64_t(0);
+            for (auto quarter = 0; quarter < 4; quarter++)
+            {
+                auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * quarter));
+                auto lowMatch = _mm_shuffle_epi8(low, _mm_and_si128(bytes, nibble));
+                auto highMatch = _mm_shuffle_epi8(high, _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble));
+                auto other = _mm_cmpeq_epi8(_mm_and_si128(lowMatch, highMatch), _mm_setzero_si128());
+                others |= uint64_t(static_cast<uint32_t>(_mm_movemask_epi8(other))) << (16 * quarter);
+            }
+            return ~others;
+        }
+        default:
+        {
+            auto bits = uint64_t(0);
+            for (auto ii = 0; ii < 64; ii++)
+            {
+                bits |= uint64_t(isDelimiter[static_cast<unsigned char>(block[ii])] ? 1 : 0) << ii;
+            }
+            return bits;
+        }
+        }
+    }
+
+    void Tokenizer::LoadBlock(size_t newBase)
+    {
+        base = newBase;
+
+        auto available = text.size() - base;
+        if (available >= 64)
+        {
+            delimiterBits = Classify(text.data() + base);
+        }
+        else
+        {
+            char padded[64] = {};
+            memcpy(padded, text.data() + base, available);
+            delimiterBits = Classify(padded) | (~uint64_t(0) << available);
+        }
+    }
+
+    bool Tokenizer::Next(std::string_view& token)
+    {
+        // Skip delimiters. Bytes past the end count as delimiters, so a
+        // start found in the last block is inside the text.
+        while (true)
+        {
+            if (position >= text.size())
+            {
+                return false;
+            }
+
+            if (position - base >= 64)
+            {
+                LoadBlock(position & ~size_t(63));
+            }
+
+            auto starts = ~delimiterBits >> (position - base);
+            if (starts != 0)
+            {
+                position += TrailingZeroBits(starts);
+                break;
+            }
+
+            position = base + 64;
+        }
+
+        auto start = position;
+        while (position < text.size())
+        {
+            if (position - base >= 64)
+            {
+                LoadBlock(position & ~size_t(63));
+            }
+
+            auto ends = delimiterBits >> (position - base);
+            if (ends != 0)
+            {
+                position += TrailingZeroBits(ends);
+                break;
+            }
+
+            position = base + 64;
+        }
+
+        token = text.substr(start, std::min(position, text.size()) - start);
+        return true;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Simd.h"
+#include "Utilities.h"
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+namespace AdventOfCode2017
+{
+    // Splits text into the non-empty runs of bytes between delimiters, as
+    // views into the text. Delimiters are found 64 bytes at a time: each
+    // byte's low and high nibble index two 16-entry tables whose AND is
+    // non-zero exactly for delimiters, giving a 64-bit mask per block.
+    //
+    // The tables can tell apart any delimiter set whose bytes use at most 8
+    // distinct high nibbles; larger sets fall back to a scalar lookup.
+    class Tokenizer
+    {
+    public:
+        using iterator = LineIterator<Tokenizer>;
+
+        explicit Tokenizer(std::string_view text, std::string_view delimiters = " \t\r\n", SimdLevel level = DetectSimdLevel());
+
+        bool Next(std::string_view& token);
+
+        iterator begin() { return iterator(this); }
+
+        iterator end() { return iterator(); }
+
+    private:
+        uint64_t Classify(const char* block) const;
+        void LoadBlock(size_t newBase);
+
+        std::string_view text;
+        SimdLevel level;
+        alignas(16) uint8_t lowNibbles[16];
+        alignas(16) uint8_t highNibbles[16];
+        bool isDelimiter[256];
+
+        // The 64-byte block starting at base, with one bit per delimiter
+        // (bytes past the end count as delimiters), and the next position
+        // to look at.
+        size_t base;
+        uint64_t delimiterBits;
+        size_t position;
+    };
+}
\ No newline at end of file
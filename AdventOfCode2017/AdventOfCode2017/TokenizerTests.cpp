@@ -0,0 +1,51 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "Tokenizer.h"
+#include "Utilities.h"
+#include <string>
+#include <string_view>
+#include <random>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace AdventOfCode2017
+{
+    // Named apart from the Tokenizer class it tests.
+    TEST_CLASS(TokenizerTests)
+    {
+    public:
+        TEST_METHOD(Tokenizer_Test1)
+        {
+            // Random bytes, including ones above 0x7f, against NextToken. The
+            // last delimiter set uses more high nibbles than the vector
+            // tables can hold.
+            std::mt19937 random(9);
+            std::uniform_int_distribution<int> bytes(0, 255);
+            const std::string delimiterSets[] = { " \r\n", ",", "\x80\xff a", std::string("\0\x11\x22\x33\x44\x55\x66\x77\x88", 9) };
+
+            for (auto& delimiters : delimiterSets)
+            {
+                for (auto length = size_t(0); length < 300; length++)
+                {
+                    std::string text;
+                    for (auto ii = size_t(0); ii < length; ii++)
+                    {
+                        auto byte = bytes(random);
+                        text.push_back(byte < 96 ? delimiters[byte % delimiters.size()] : static_cast<char>(byte));
+                    }
+
+                    for (auto level = 0; level <= static_cast<int>(DetectSimdLevel()); level++)
+                    {
+                        auto remaining = std::string_view(text);
+                        for (auto token : Tokenizer(text, delimiters, static_cast<SimdLevel>(level)))
+                        {
+                            auto expected = NextToken(remaining, delimiters);
+                            Assert::IsTrue(token.data() == expected.data() && token.size() == expected.size());
+                        }
+                        Assert::IsTrue(NextToken(remaining, delimiters).empty());
+                    }
+                }
+            }
+        }
+    };
+}
\ No newline at end of file
@@ -1,55 +1,387 @@
 #include "stdafx.h"
 #include "CppUnitTest.h"
 #include "Utilities.h"
-#include <fstream>
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <intrin.h>
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
 namespace AdventOfCode2017
 {
-    std::string ReadFile(const std::string& fileName)
+    namespace
     {
-        std::string result;
+        // For each 8-bit keep mask, the pshufb indices that gather the kept
+        // bytes of an 8-byte group to its front, and how many there are.
+        struct compactTable
+        {
+            uint64_t shuffle[256];
+            uint8_t count[256];
 
-        std::ifstream input(fileName);
+            compactTable()
+            {
+                for (auto mask = 0; mask < 256; mask++)
+                {
+                    auto indices = uint64_t(0);
+                    auto kept = 0;
 
-        if (input.fail())
+                    for (auto bit = 0; bit < 8; bit++)
+                    {
+                        if ((mask & (1 << bit)) != 0)
+                        {
+                            indices |= uint64_t(bit) << (8 * kept);
+                            kept++;
+                        }
+                    }
+
+                    shuffle[mask] = indices;
+                    count[mask] = static_cast<uint8_t>(kept);
+                }
+            }
+        };
+
+        const compactTable& CompactTable()
         {
-            throw 1;
+            static const compactTable table;
+            return table;
+        }
+
+        bool IsWhitespace(char ch)
+        {
+            return ch == ' ' || static_cast<unsigned char>(ch - '\t') <= '\r' - '\t';
+        }
+
+        char* StripScalar(const char* input, const char* end, char* output)
+        {
+            for (; input < end; input++)
+            {
+                *output = *input;
+                output += IsWhitespace(*input) ? 0 : 1;
+            }
+
+            return output;
+        }
+
+        __m128i WhitespaceMask(__m128i bytes)
+        {
+            auto spaces = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '));
+            auto shifted = _mm_sub_epi8(bytes, _mm_set1_epi8('\t'));
+            auto controls = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8('\r' - '\t')), shifted);
+            return _mm_or_si128(spaces, controls);
+        }
+
+        __m256i WhitespaceMask(__m256i bytes)
+        {
+            auto spaces = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' '));
+            auto shifted = _mm256_sub_epi8(bytes, _mm256_set1_epi8('\t'));
+            auto controls = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8('\r' - '\t')), shifted);
+            return _mm256_or_si256(spaces, controls);
+        }
+
+        char* Compact(__m128i bytes, unsigned keep, char* output, const compactTable& table)
+        {
+            auto low = keep & 0xFF;
+            auto high = (keep >> 8) & 0xFF;
+
+            auto shuffle = _mm_set_epi64x(table.shuffle[high] + 0x0808080808080808ull, table.shuffle[low]);
+            auto packed = _mm_shuffle_epi8(bytes, shuffle);
+
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(output), packed);
+            output += table.count[low];
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(output), _mm_unpackhi_epi64(packed, packed));
+            return output + table.count[high];
+        }
+
+        char* StripSse41(const char* input, const char* end, char* output)
+        {
+            auto& table = CompactTable();
+
+            for (; end - input >= 16; input += 16)
+            {
+                auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+                auto keep = ~static_cast<unsigned>(_mm_movemask_epi8(WhitespaceMask(bytes))) & 0xFFFF;
+
+                if (keep == 0xFFFF)
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(output), bytes);
+                    output += 16;
+                }
+                else
+                {
+                    output = Compact(bytes, keep, output, table);
+                }
+            }
+
+            return StripScalar(input, end, output);
         }
 
-        char ch;
-        input >> ch;
-        while (!input.eof())
+        char* StripAvx2(const char* input, const char* end, char* output)
         {
-            result.push_back(ch);
-            input >> ch;
+            auto& table = CompactTable();
+
+            for (; end - input >= 32; input += 32)
+            {
+                auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input));
+                auto keep = ~static_cast<unsigned>(_mm256_movemask_epi8(WhitespaceMask(bytes)));
+
+                if (keep == 0xFFFFFFFF)
+                {
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output), bytes);
+                    output += 32;
+                }
+                else
+                {
+                    output = Compact(_mm256_castsi256_si128(bytes), keep & 0xFFFF, output, table);
+                    output = Compact(_mm256_extracti128_si256(bytes, 1), keep >> 16, output, table);
+                }
+            }
+
+            return StripSse41(input, end, output);
+        }
+    }
+
+    size_t StripWhitespace(std::string_view input, char* output, SimdLevel level)
+    {
+        auto begin = input.data();
+        auto end = begin + input.size();
+        char* last;
+
+        switch (level)
+        {
+        case SimdLevel::Avx2:
+            last = StripAvx2(begin, end, output);
+            break;
+        case SimdLevel::Sse41:
+            last = StripSse41(begin, end, output);
+            break;
+        default:
+            last = StripScalar(begin, end, output);
+            break;
         }
 
+        return last - output;
+    }
+
+    std::string ReadFile(const std::string& fileName)
+    {
+        MappedInput input(fileName);
+
+        std::string result(input.Size() + 16, '\0');
+        result.resize(StripWhitespace(input.Contents(), &result[0]));
+
         return result;
     }
 
     std::vector<std::string> ReadAllLines(const std::string& fileName)
     {
-        std::vector<std::string> result;
+        MappedInput input(fileName);
+        auto& lines = input.Lines();
+
+        return std::vector<std::string>(lines.begin(), lines.end());
+    }
+
+    std::vector<std::string_view> SplitLines(std::string_view contents)
+    {
+        std::vector<std::string_view> result;
+        ForEachLine(contents, [&result](std::string_view line) { result.push_back(line); });
+        return result;
+    }
+
+    MappedInput::MappedInput(const std::string& fileName) :
+        file(INVALID_HANDLE_VALUE),
+        mapping(nullptr),
+        data(nullptr),
+        length(0),
+        indexed(false)
+    {
+        file = CreateFileA(
+            fileName.c_str(),
+            GENERIC_READ,
+            FILE_SHARE_READ,
+            nullptr,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+            nullptr);
+
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            throw 1;
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || static_cast<unsigned long long>(size.QuadPart) > SIZE_MAX)
+        {
+            Close();
+            throw 1;
+        }
 
-        std::ifstream input(fileName);
+        length = static_cast<size_t>(size.QuadPart);
 
+        // Empty files cannot be mapped; they are simply an empty view.
+        if (length == 0)
+        {
+            return;
+        }
+
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr)
+        {
+            Close();
+            throw 1;
+        }
+
+        data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (data == nullptr)
+        {
+            Close();
+            throw 1;
+        }
+    }
+
+    MappedInput::MappedInput(MappedInput&& other) noexcept :
+        file(other.file),
+        mapping(other.mapping),
+        data(other.data),
+        length(other.length),
+        lines(std::move(other.lines)),
+        indexed(other.indexed)
+    {
+        other.file = INVALID_HANDLE_VALUE;
+        other.mapping = nullptr;
+        other.data = nullptr;
+        other.length = 0;
+        other.indexed = false;
+    }
+
+    MappedInput& MappedInput::operator=(MappedInput&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Close();
+            std::swap(file, other.file);
+            std::swap(mapping, other.mapping);
+            std::swap(data, other.data);
+            std::swap(length, other.length);
+            std::swap(lines, other.lines);
+            std::swap(indexed, other.indexed);
+        }
+
+        return *this;
+    }
+
+    MappedInput::~MappedInput()
+    {
+        Close();
+    }
+
+    const std::vector<std::string_view>& MappedInput::Lines() const
+    {
+        if (!indexed)
+        {
+            lines = SplitLines(Contents());
+            indexed = true;
+        }
+
+        return lines;
+    }
+
+    void MappedInput::Close()
+    {
+        if (data != nullptr)
+        {
+            UnmapViewOfFile(data);
+            data = nullptr;
+        }
+
+        if (mapping != nullptr)
+        {
+            CloseHandle(mapping);
+            mapping = nullptr;
+        }
+
+        if (file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(file);
+            file = INVALID_HANDLE_VALUE;
+        }
+
+        length = 0;
+        lines.clear();
+        indexed = false;
+    }
+
+    LineReader::LineReader(const std::string& fileName, size_t bufferSize) :
+        input(fileName, std::ios::in | std::ios::binary),
+        buffer(std::max(bufferSize, size_t(1))),
+        start(0),
+        filled(0),
+        exhausted(false)
+    {
         if (input.fail())
         {
             throw 1;
         }
+    }
+
+    bool LineReader::Next(std::string_view& line)
+    {
+        while (true)
+        {
+            auto begin = buffer.data() + start;
+            auto available = filled - start;
+            auto newline = static_cast<const char*>(memchr(begin, '\n', available));
+
+            if (newline != nullptr || (exhausted && available > 0))
+            {
+                auto length = newline != nullptr ? static_cast<size_t>(newline - begin) : available;
+                start += newline != nullptr ? length + 1 : length;
+
+                if (length > 0 && begin[length - 1] == '\r')
+                {
+                    length--;
+                }
+
+                line = std::string_view(begin, length);
+                return true;
+            }
+
+            if (exhausted || !Refill())
+            {
+                return false;
+            }
+        }
+    }
 
-        while (!input.eof())
+    bool LineReader::Refill()
+    {
+        // Slide the partial line to the front so the rest of the buffer can
+        // be filled; only grow when that partial line already fills it.
+        if (start > 0)
         {
-            char buffer[1024];
-            input.getline(buffer, sizeof(buffer) / sizeof(buffer[0]));
-            result.push_back(buffer);
+            std::copy(buffer.begin() + start, buffer.begin() + filled, buffer.begin());
+            filled -= start;
+            start = 0;
         }
 
-        input.close();
+        if (filled == buffer.size())
+        {
+            buffer.resize(buffer.size() * 2);
+        }
 
-        return result;
+        input.read(buffer.data() + filled, buffer.size() - filled);
+        auto count = static_cast<size_t>(input.gcount());
+        filled += count;
+
+        if (count == 0)
+        {
+            exhausted = true;
+        }
+
+        return filled > start;
     }
 }
\ No newline at end of file
@@ -1,10 +1,230 @@
 #pragma once
 
+#include "Simd.h"
 #include <vector>
 #include <string>
+#include <string_view>
+#include <fstream>
+#include <iterator>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
 
 namespace AdventOfCode2017
 {
+    // Every line of the file without its line ending. A newline at the end
+    // of the file ends the last line rather than starting an empty one, so
+    // "a\nb\n" gives two lines, as MappedInput::Lines does.
     std::vector<std::string> ReadAllLines(const std::string& fileName);
     std::string ReadFile(const std::string& fileName);
+
+    // Copies input to output without the bytes isspace treats as whitespace in
+    // the "C" locale and returns the number of bytes kept. The vector paths
+    // store whole blocks, so output needs room for input.size() + 16 bytes.
+    size_t StripWhitespace(std::string_view input, char* output, SimdLevel level = DetectSimdLevel());
+
+    // Read-only view of an entire input file mapped into memory. Contents and
+    // lines are views into the mapping, so they are only valid while the
+    // MappedInput is alive.
+    class MappedInput
+    {
+    public:
+        explicit MappedInput(const std::string& fileName);
+        MappedInput(MappedInput&& other) noexcept;
+        MappedInput& operator=(MappedInput&& other) noexcept;
+        ~MappedInput();
+
+        MappedInput(const MappedInput&) = delete;
+        MappedInput& operator=(const MappedInput&) = delete;
+
+        std::string_view Contents() const { return std::string_view(data, length); }
+
+        size_t Size() const { return length; }
+
+        // Lines split on '\n' with any trailing '\r' removed. A newline at the
+        // very end of the file does not produce an extra empty line.
+        const std::vector<std::string_view>& Lines() const;
+
+    private:
+        void Close();
+
+        void* file;
+        void* mapping;
+        const char* data;
+        size_t length;
+        mutable std::vector<std::string_view> lines;
+        mutable bool indexed;
+    };
+
+    // Calls action with each line of contents, split the same way as
+    // MappedInput::Lines, without allocating.
+    template<class Action>
+    void ForEachLine(std::string_view contents, Action&& action)
+    {
+        auto begin = contents.data();
+        auto end = begin + contents.size();
+
+        while (begin < end)
+        {
+            auto newline = static_cast<const char*>(memchr(begin, '\n', end - begin));
+            auto lineEnd = newline != nullptr ? newline : end;
+            auto length = static_cast<size_t>(lineEnd - begin);
+
+            if (length > 0 && begin[length - 1] == '\r')
+            {
+                length--;
+            }
+
+            action(std::string_view(begin, length));
+            begin = lineEnd + 1;
+        }
+    }
+
+    std::vector<std::string_view> SplitLines(std::string_view contents);
+
+    // Returns the next token of text bounded by any of delimiters and advances
+    // text past it. Returns an empty view once no tokens are left.
+    inline std::string_view NextToken(std::string_view& text, std::string_view delimiters = " \t\r\n")
+    {
+        auto start = text.find_first_not_of(delimiters);
+        if (start == std::string_view::npos)
+        {
+            text.remove_prefix(text.size());
+            return std::string_view();
+        }
+
+        auto end = text.find_first_of(delimiters, start);
+        if (end == std::string_view::npos)
+        {
+            end = text.size();
+        }
+
+        auto token = text.substr(start, end - start);
+        text.remove_prefix(end);
+        return token;
+    }
+
+    // Input iterator over the lines of any reader with a
+    // bool Next(std::string_view&) member.
+    template<class Reader>
+    class LineIterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string_view*;
+        using reference = const std::string_view&;
+
+        LineIterator() : reader(nullptr) { }
+
+        explicit LineIterator(Reader* lineReader) : reader(lineReader)
+        {
+            ++(*this);
+        }
+
+        reference operator*() const { return current; }
+
+        pointer operator->() const { return &current; }
+
+        LineIterator& operator++()
+        {
+            if (!reader->Next(current))
+            {
+                reader = nullptr;
+            }
+
+            return *this;
+        }
+
+        bool operator==(const LineIterator& other) const { return reader == other.reader; }
+
+        bool operator!=(const LineIterator& other) const { return reader != other.reader; }
+
+    private:
+        Reader* reader;
+        std::string_view current;
+    };
+
+    // Streams the lines of a file through a fixed-size buffer that is refilled
+    // as it is consumed, so memory use does not depend on the file size. The
+    // buffer only grows if a single line does not fit in it. Each line view is
+    // invalidated by the next call to Next (or iterator increment). Line
+    // splitting follows the same rules as MappedInput::Lines.
+    class LineReader
+    {
+    public:
+        using iterator = LineIterator<LineReader>;
+
+        static const size_t DefaultBufferSize = 64 * 1024;
+
+        explicit LineReader(const std::string& fileName, size_t bufferSize = DefaultBufferSize);
+
+        LineReader(const LineReader&) = delete;
+        LineReader& operator=(const LineReader&) = delete;
+
+        bool Next(std::string_view& line);
+
+        iterator begin() { return iterator(this); }
+
+        iterator end() { return iterator(); }
+
+    private:
+        bool Refill();
+
+        std::ifstream input;
+        std::vector<char> buffer;
+        size_t start;
+        size_t filled;
+        bool exhausted;
+    };
+
+    // The MurmurHash3 finalizer: spreads every input bit over the whole
+    // word, for hash tables keyed on values that differ only in a few bits.
+    inline uint64_t Mix(uint64_t value)
+    {
+        value ^= value >> 33;
+        value *= 0xFF51AFD7ED558CCDull;
+        value ^= value >> 33;
+        value *= 0xC4CEB9FE1A85EC53ull;
+        value ^= value >> 33;
+        return value;
+    }
+
+    // Unsigned 128-bit integer with just the arithmetic the puzzles need, as
+    // MSVC has no built-in 128-bit type. Addition wraps like the built-in
+    // unsigned types; value-initialization gives zero.
+    struct UInt128
+    {
+        uint64_t low;
+        uint64_t high;
+
+        UInt128& operator+=(const UInt128& other)
+        {
+            auto sum = low + other.low;
+            high += other.high + (sum < low ? 1 : 0);
+            low = sum;
+            return *this;
+        }
+    };
+
+    inline UInt128 operator+(UInt128 left, const UInt128& right)
+    {
+        return left += right;
+    }
+
+    inline bool operator==(const UInt128& left, const UInt128& right)
+    {
+        return left.low == right.low && left.high == right.high;
+    }
+
+    inline bool operator<(const UInt128& left, const UInt128& right)
+    {
+        return left.high < right.high || (left.high == right.high && left.low < right.low);
+    }
+
+    inline bool operator>(const UInt128& left, const UInt128& right)
+    {
+        return right < left;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "Utilities.h"
+#include "ReadAhead.h"
+#include <string>
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <filesystem>
+#include <cstdio>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace AdventOfCode2017
+{
+    TEST_CLASS(Utilities)
+    {
+    public:
+        TEST_METHOD(Utilities_Test1)
+        {
+            auto lines = SplitLines("aa bb\r\ncc\n\ndd\n");
+            Assert::AreEqual(size_t(4), lines.size());
+            Assert::IsTrue(lines[0] == "aa bb");
+            Assert::IsTrue(lines[1] == "cc");
+            Assert::IsTrue(lines[2].empty());
+            Assert::IsTrue(lines[3] == "dd");
+        }
+
+        TEST_METHOD(Utilities_Test2)
+        {
+            auto input = MappedInput("C:\\Day4.txt");
+            auto& expected = input.Lines();
+
+            // A buffer shorter than most lines forces both refills and growth.
+            LineReader reader("C:\\Day4.txt", 16);
+            auto count = size_t(0);
+            for (auto iter = reader.begin(); iter != reader.end(); ++iter, count++)
+            {
+                Assert::IsTrue(count < expected.size());
+                Assert::IsTrue(expected[count] == *iter);
+            }
+            Assert::AreEqual(expected.size(), count);
+        }
+
+        TEST_METHOD(Utilities_Test3)
+        {
+            auto input = MappedInput("C:\\Day4.txt");
+            auto& expected = input.Lines();
+
+            // Blocks shorter than a line make most lines straddle blocks.
+            for (auto blockSize : { size_t(1), size_t(7), size_t(64), size_t(4096) })
+            {
+                AsyncLineReader reader("C:\\Day4.txt", blockSize, 1 + blockSize % 3);
+                auto count = size_t(0);
+                for (auto iter = reader.begin(); iter != reader.end(); ++iter, count++)
+                {
+                    Assert::IsTrue(count < expected.size());
+                    Assert::IsTrue(expected[count] == *iter);
+                }
+                Assert::AreEqual(expected.size(), count);
+            }
+
+            // Stopping early must still shut the reader thread down.
+            AsyncLineReader partial("C:\\Day4.txt", 8);
+            Assert::IsTrue(partial.begin() != partial.end());
+        }
+
+        TEST_METHOD(Utilities_Test4)
+        {
+            std::string input;
+            const std::string whitespace = " \t\n\v\f\r";
+
+            for (auto ii = 0; ii < 1000; ii++)
+            {
+                input.push_back(static_cast<char>('!' + (ii * 7) % 90));
+
+                if (ii % 3 == 0 || ii % 11 == 0)
+                {
+                    input.push_back(whitespace[ii % whitespace.size()]);
+                }
+            }
+
+            for (auto level = 0; level <= static_cast<int>(DetectSimdLevel()); level++)
+            {
+                for (auto length = size_t(0); length <= input.size(); length += 13)
+                {
+                    std::string output(length + 16, '\0');
+                    output.resize(StripWhitespace(std::string_view(input).substr(0, length), &output[0], static_cast<SimdLevel>(level)));
+
+                    auto reference = std::string(input, 0, length);
+                    reference.erase(std::remove_if(reference.begin(), reference.end(), [](char ch) { return isspace(ch) != 0; }), reference.end());
+                    Assert::AreEqual(reference, output);
+                }
+            }
+        }
+
+        TEST_METHOD(Utilities_Test5)
+        {
+            const auto fileName = (std::filesystem::temp_directory_path() / "Utilities-lines.txt").string();
+            {
+                std::ofstream output(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+                output << "a\r\n\nb\n";
+            }
+
+            auto lines = ReadAllLines(fileName);
+            std::remove(fileName.c_str());
+
+            Assert::AreEqual(size_t(3), lines.size());
+            Assert::AreEqual(std::string("a"), lines[0]);
+            Assert::IsTrue(lines[1].empty());
+            Assert::AreEqual(std::string("b"), lines[2]);
+        }
+    };
+}
\ No newline at end of file